@@ -0,0 +1,27 @@
+# Writes an asset pack into a C++ source file that registers it as the embedded pack.
+# Only used for compilers without .incbin, e.g. MSVC. The pack is converted in chunks, so memory use stays flat,
+# but CMake only converts a few megabytes per second and the compiler has to parse every byte, so keep the pack to a few dozen megabytes there.
+# Usage: cmake -DPACK_FILE=<pack> -DSOURCE_FILE=<output> -P EmbedPack.cmake
+
+set(chunk_size 65536)
+file(SIZE ${PACK_FILE} pack_size)
+
+file(WRITE ${SOURCE_FILE}
+"// Generated by bee_embed_assets, do not edit.
+#include <Bee/Assets.hpp>
+
+alignas(16) static const unsigned char embeddedPack[] = {
+")
+
+set(offset 0)
+while(offset LESS pack_size)
+    file(READ ${PACK_FILE} pack_hex OFFSET ${offset} LIMIT ${chunk_size} HEX)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," pack_bytes "${pack_hex}")
+    file(APPEND ${SOURCE_FILE} "${pack_bytes}\n")
+    math(EXPR offset "${offset} + ${chunk_size}")
+endwhile()
+
+file(APPEND ${SOURCE_FILE}
+"};
+static const bool embeddedPackRegistered = (Assets::setEmbeddedPack(embeddedPack, sizeof(embeddedPack)), true);
+")
@@ -0,0 +1,51 @@
+/**
+ * @file Assets.hpp
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @namespace Assets
+ * 
+ * @brief All the asset file related functions.
+ * 
+ */
+namespace Assets
+{
+    /**
+     * @brief Load assets from a pack file instead of the assets directory. ./assets.pack is mounted automatically if it exists. Mount a pack before loading assets from it, mounting another one replaces it.
+     * 
+     * @param path the path of the pack file
+     * @return true if the pack was mounted, false otherwise
+     */
+    bool mountPack(const std::string& path);
+
+    /**
+     * @brief Use a pack that is compiled into the executable, e.g. by the bee_embed_assets CMake function, which calls this during static initialization. Call it before Bee::init. The embedded pack is mounted instead of ./assets.pack, and the decoded image and sprite sheet caches are not used, so loading assets doesn't touch the file system unless loose files override the pack.
+     * 
+     * @param data the pack data, aligned to 8 bytes and valid for the lifetime of the program
+     * @param size the size of the pack data in bytes
+     */
+    void setEmbeddedPack(const void* data, size_t size);
+
+    /**
+     * @brief Let loose files in the assets directory override files in the mounted pack. Enabled by default in debug builds.
+     * 
+     * @param enabled true to look for loose files first, false to only read from the pack
+     */
+    void setLooseFileOverride(bool enabled);
+
+    /**
+     * @brief Load the sprites, tilesets, fonts, music and sounds listed in a manifest before they are needed, e.g. from onInit or a world's onLoad. Images and sounds are decoded on worker threads, the function returns once everything is loaded. The load time of every asset is logged.
+     * 
+     * A manifest is a JSON file in the Manifests directory:
+     * {"sprites": ["Player"], "tilesets": ["Forest"], "fonts": [{"name": "Arial", "size": 16}], "music": ["Theme"], "sounds": ["Jump"]}
+     * 
+     * @param manifestName the name of the manifest
+     * @return true if all assets were loaded, false otherwise
+     */
+    bool preload(const std::string& manifestName);
+};
@@ -68,4 +68,32 @@ namespace Audio
      * 
      */
     void unloadAllSounds();
+
+    /**
+     * @brief Get the approximate memory used by loaded music.
+     * 
+     * @return the size of all loaded music files in bytes
+     */
+    size_t getMusicMemory();
+
+    /**
+     * @brief Get the memory used by loaded sounds.
+     * 
+     * @return the size of all decoded sounds in bytes
+     */
+    size_t getSoundMemory();
+
+    /**
+     * @brief Set how much memory loaded music may use. When the budget is exceeded, the least recently used music that is not playing is unloaded. Unlimited by default.
+     * 
+     * @param bytes the music budget in bytes
+     */
+    void setMusicBudget(size_t bytes);
+
+    /**
+     * @brief Set how much memory loaded sounds may use. When the budget is exceeded, the least recently used sounds that are not playing are unloaded. Unlimited by default.
+     * 
+     * @param bytes the sound budget in bytes
+     */
+    void setSoundBudget(size_t bytes);
 };
\ No newline at end of file
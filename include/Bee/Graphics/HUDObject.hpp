@@ -50,9 +50,9 @@ public:
     Vector2i getTextureSize() const;
 
     /**
-     * @brief Check if the cursor is on the HUD object.
+     * @brief Check if the cursor is on the HUD object. Only the topmost HUD object under the cursor counts.
      * 
-     * @return true if the cursor is on the HUD object, false otherwise.
+     * @return true if the cursor is on the HUD object and no other HUD object is drawn on top of it, false otherwise.
      */
     bool isCursorOnMe() const;
 
@@ -23,6 +23,12 @@ namespace Renderer
      */
     void unloadAllFonts();
 
+    /**
+     * @brief Drop cache entries of sprites that no entity or HUD object uses anymore. Sprite sheets are unloaded and release their texture on their own once their last sprite is gone, so this is rarely needed.
+     * 
+     */
+    void unloadUnusedSprites();
+
     /**
      * @brief Unload all loaded textures.
      * 
@@ -57,6 +63,56 @@ namespace Renderer
      */
     Vector2i getWindowSize();
 
+    /**
+     * @brief Get the number of draw calls of the last rendered frame.
+     * 
+     * @return the number of draw calls submitted to SDL.
+     */
+    int getDrawCalls();
+
+    /**
+     * @brief Get the approximate memory used by loaded textures. Texture atlases count with their full size, however much of them is used.
+     * 
+     * @return the size of all loaded textures and texture atlases in bytes
+     */
+    size_t getTextureMemory();
+
+    /**
+     * @brief Get the approximate memory used by loaded fonts.
+     * 
+     * @return the size of all loaded font files in bytes
+     */
+    size_t getFontMemory();
+
+    /**
+     * @brief Get the number of texture atlases sprites and tilesets have been packed into.
+     * 
+     * @return the number of atlas textures
+     */
+    int getAtlasCount();
+
+    /**
+     * @brief Get how much of a texture atlas is covered by packed images.
+     * 
+     * @param index the index of the atlas
+     * @return the used fraction of the atlas area between 0 and 1, 0 for an invalid index
+     */
+    float getAtlasOccupancy(int index);
+
+    /**
+     * @brief Get the number of texture switches of the last rendered frame.
+     * 
+     * @return the number of texture switches after sorting the draws by texture.
+     */
+    int getTextureSwitches();
+
+    /**
+     * @brief Get the number of texture switches the last rendered frame would have had without sorting.
+     * 
+     * @return the number of texture switches in the order the draws were submitted.
+     */
+    int getUnsortedTextureSwitches();
+
     /**
      * @brief Set the window to fullscreen or windowed mode.
      * 
@@ -78,6 +134,76 @@ namespace Renderer
      */
     void setWindowTitle(const std::string& title);
 
+    /**
+     * @brief Decode sprite images on worker threads. A sprite is invisible until its image has been decoded and uploaded. Enabled by default.
+     * 
+     * @param enabled true to load sprite images in the background, false to load them when the sprite is set
+     */
+    void setAsyncTextureLoading(bool enabled);
+
+    /**
+     * @brief Set how much time per frame may be spent uploading decoded images to the GPU. At least one image is uploaded every frame. Defaults to 2 ms.
+     * 
+     * @param milliseconds the upload budget per frame in milliseconds
+     */
+    void setTextureUploadBudget(float milliseconds);
+
+    /**
+     * @brief Cache decoded images in ./cache/Textures, so they don't have to be decoded again on the next start. An image is decoded again when its file changes. Enabled by default.
+     * 
+     * @param enabled true to read and write the cache, false to always decode images
+     */
+    void setTextureDiskCache(bool enabled);
+
+    /**
+     * @brief Set how much disk space the decoded image cache may use. When the budget is exceeded, the least recently used images are removed from the cache. Defaults to 256 MiB.
+     * 
+     * @param bytes the cache size in bytes
+     */
+    void setTextureDiskCacheBudget(size_t bytes);
+
+    /**
+     * @brief Set the size of the atlas textures that sprites and tilesets are packed into. Images larger than half the size get their own texture. Only affects textures loaded afterwards. Defaults to 2048.
+     * 
+     * @param size the width and height of new atlases in pixels, 0 to disable packing
+     */
+    void setAtlasSize(int size);
+
+    /**
+     * @brief Set how much memory loaded textures may use. When the budget is exceeded, the least recently used textures that no sprite or tileset uses anymore are unloaded. Textures packed into an atlas count with their own size, and the space they leave behind is reused by the next packed textures. Unlimited by default.
+     * 
+     * @param bytes the texture budget in bytes
+     */
+    void setTextureBudget(size_t bytes);
+
+    /**
+     * @brief Set how much memory loaded fonts may use. When the budget is exceeded, the least recently used fonts that no text uses anymore are unloaded. Unlimited by default.
+     * 
+     * @param bytes the font budget in bytes
+     */
+    void setFontBudget(size_t bytes);
+
+    /**
+     * @brief Set how much memory the cache of laid out texts may use. Texts that were shown recently are reused without being laid out again. Defaults to 1 MiB.
+     * 
+     * @param bytes the budget of the text cache in bytes
+     */
+    void setTextCacheBudget(size_t bytes);
+
+    /**
+     * @brief Draw consecutive tiles and sprites that share a texture with a single SDL_RenderGeometry call. Enabled by default.
+     * 
+     * @param enabled true to batch draws, false to draw every tile and sprite with its own copy call
+     */
+    void setGeometryBatching(bool enabled);
+
+    /**
+     * @brief Allow entity sprites to be reordered by texture to reduce texture switches. Overlapping entities with different textures may then be drawn in a different order.
+     * 
+     * @param enabled true to sort sprites by texture, false to draw them in the order of the world
+     */
+    void setSpriteTextureSorting(bool enabled);
+
     /**
      * @brief Set the position of the camera
      * 
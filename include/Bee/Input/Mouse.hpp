@@ -56,4 +56,19 @@ namespace Mouse
      * @param hotY the Y hotspot of the cursor
      */
     void createCustomCursor(const std::string& path, int hotX, int hotY);
+
+    /**
+     * @brief Set the state of a mouse button as if it was pressed or released, e.g. to drive the game from automated tests in headless mode.
+     * 
+     * @param button the button to set
+     * @param down true if the button is pressed, false if it is released
+     */
+    void setButtonDown(MouseButton button, bool down);
+
+    /**
+     * @brief Move the mouse position the game sees without moving the cursor.
+     * 
+     * @param position the position of the mouse in screen coordinates
+     */
+    void setMouseScreenPosition(const Vector2i& position);
 }
\ No newline at end of file
@@ -0,0 +1,74 @@
+/**
+ * @file Jobs.hpp
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct Job;
+
+/**
+ * @brief A handle to a scheduled job, used to wait for it or to make other jobs depend on it.
+ * 
+ */
+using JobHandle = std::shared_ptr<Job>;
+
+/**
+ * @namespace Jobs
+ * 
+ * @brief All the job system related functions. Jobs run on a pool of worker threads, idle workers steal jobs queued by busy ones.
+ * 
+ */
+namespace Jobs
+{
+    /**
+     * @brief Run a function on a worker thread. Jobs must not log or use the renderer, audio or input.
+     * 
+     * @param task the function to run
+     * @param dependencies jobs that have to finish before this one starts
+     * @return a handle to the job
+     */
+    JobHandle run(const std::function<void()>& task, const std::vector<JobHandle>& dependencies = {});
+
+    /**
+     * @brief Wait for a job to finish. The calling thread runs queued jobs while it waits.
+     * 
+     * @param job the job to wait for
+     */
+    void wait(const JobHandle& job);
+
+    /**
+     * @brief Check if a job has finished.
+     * 
+     * @param job the job to check
+     * @return true if the job has finished, false otherwise
+     */
+    bool isFinished(const JobHandle& job);
+
+    /**
+     * @brief Call a function for ranges of indices from 0 to count on all workers and the calling thread, returns once every index has been processed.
+     * 
+     * @param count the number of indices
+     * @param function the function called with the first and one past the last index of a range
+     * @param grainSize the minimum number of indices in a range
+     */
+    void parallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& function, size_t grainSize = 1);
+
+    /**
+     * @brief Get the number of worker threads.
+     * 
+     * @return the number of worker threads
+     */
+    unsigned int getWorkerCount();
+
+    /**
+     * @brief Set the number of worker threads. Only takes effect before the first job is run. Defaults to one less than the number of CPU cores.
+     * 
+     * @param count the number of worker threads, 0 to run every job on the calling thread
+     */
+    void setWorkerCount(unsigned int count);
+}
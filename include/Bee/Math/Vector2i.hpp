@@ -5,13 +5,46 @@ struct Vector2i
     int x;
     int y;
 
-    Vector2i();
-    Vector2i(int x, int y);
-    void operator+=(const Vector2i& other);
-    void operator-=(const Vector2i& other);
-    bool operator==(const Vector2i& other) const;
-    Vector2i operator+(const Vector2i& other) const;
-    Vector2i operator-(const Vector2i& other) const;
-    Vector2i operator*(float multiplier) const;
-    Vector2i operator/(float divider) const;
-};
\ No newline at end of file
+    constexpr Vector2i()
+        : x(0), y(0) {}
+
+    constexpr Vector2i(const int x, const int y)
+        : x(x), y(y) {}
+
+    constexpr void operator+=(const Vector2i& other)
+    {
+        x += other.x;
+        y += other.y;
+    }
+
+    constexpr void operator-=(const Vector2i& other)
+    {
+        x -= other.x;
+        y -= other.y;
+    }
+
+    constexpr bool operator==(const Vector2i& other) const
+    {
+        return x == other.x && y == other.y;
+    }
+
+    constexpr Vector2i operator+(const Vector2i& other) const
+    {
+        return {x + other.x, y + other.y};
+    }
+
+    constexpr Vector2i operator-(const Vector2i& other) const
+    {
+        return {x - other.x, y - other.y};
+    }
+
+    constexpr Vector2i operator*(const float multiplier) const
+    {
+        return {static_cast<int>(x * multiplier), static_cast<int>(y * multiplier)};
+    }
+
+    constexpr Vector2i operator/(const float divider) const
+    {
+        return {static_cast<int>(x / divider), static_cast<int>(y / divider)};
+    }
+};
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Bee/Properties.hpp"
 #include "Bee/Collision/Hitbox.hpp"
 
@@ -17,5 +19,15 @@ public:
     Properties properties;
 
 private:
+    struct HitboxPart
+    {
+        Hitbox hitbox;
+        Vector2f min;
+        Vector2f max;
+    };
+
     Hitbox hitbox;
+    Vector2f min;
+    Vector2f max;
+    std::vector<HitboxPart> hitboxParts;
 };
\ No newline at end of file
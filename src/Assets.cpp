@@ -0,0 +1,322 @@
+#include "Assets.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Log.hpp"
+#include "Assets/Compression.hpp"
+#include "Assets/PackFormat.hpp"
+
+struct MemoryStream
+{
+    std::vector<uint8_t> data;
+    size_t position = 0;
+};
+
+static const uint8_t* packData = nullptr;
+static size_t packSize = 0;
+static const PackEntry* packEntries = nullptr;
+static uint32_t packEntryCount = 0;
+// Embedded packs are part of the executable and aren't unmapped.
+static bool packMapped = false;
+static const uint8_t* embeddedPackData = nullptr;
+static size_t embeddedPackSize = 0;
+#ifdef _WIN32
+static HANDLE packMapping = nullptr;
+#endif
+#ifdef NDEBUG
+static bool looseFileOverride = false;
+#else
+static bool looseFileOverride = true;
+#endif
+
+static std::string_view getEntryName(const PackEntry& entry)
+{
+    return {reinterpret_cast<const char*>(packData) + entry.nameOffset, entry.nameLength};
+}
+
+static const PackEntry* findEntry(const std::string& path)
+{
+    if (packData == nullptr) return nullptr;
+
+    // Paths from tilemaps may contain ./ or ../, pack entries are stored normalized.
+    const std::string name = std::filesystem::path(path).lexically_normal().generic_string();
+
+    const PackEntry* end = packEntries + packEntryCount;
+    const PackEntry* entry = std::lower_bound(packEntries, end, std::string_view(name), [](const PackEntry& left, const std::string_view right) {
+        return getEntryName(left) < right;
+    });
+
+    if (entry == end || getEntryName(*entry) != name) return nullptr;
+    return entry;
+}
+
+static Sint64 SDLCALL memoryStreamSize(SDL_RWops* context)
+{
+    return static_cast<Sint64>(static_cast<MemoryStream*>(context->hidden.unknown.data1)->data.size());
+}
+
+static Sint64 SDLCALL memoryStreamSeek(SDL_RWops* context, const Sint64 offset, const int whence)
+{
+    auto* stream = static_cast<MemoryStream*>(context->hidden.unknown.data1);
+
+    Sint64 position = offset;
+    if (whence == RW_SEEK_CUR) position += static_cast<Sint64>(stream->position);
+    else if (whence == RW_SEEK_END) position += static_cast<Sint64>(stream->data.size());
+
+    stream->position = static_cast<size_t>(std::clamp<Sint64>(position, 0, static_cast<Sint64>(stream->data.size())));
+    return static_cast<Sint64>(stream->position);
+}
+
+static size_t SDLCALL memoryStreamRead(SDL_RWops* context, void* buffer, const size_t size, const size_t count)
+{
+    auto* stream = static_cast<MemoryStream*>(context->hidden.unknown.data1);
+    if (size == 0) return 0;
+
+    const size_t objects = std::min(count, (stream->data.size() - stream->position) / size);
+    memcpy(buffer, stream->data.data() + stream->position, objects * size);
+    stream->position += objects * size;
+    return objects;
+}
+
+static size_t SDLCALL memoryStreamWrite(SDL_RWops*, const void*, size_t, size_t)
+{
+    return 0;
+}
+
+static int SDLCALL memoryStreamClose(SDL_RWops* context)
+{
+    delete static_cast<MemoryStream*>(context->hidden.unknown.data1);
+    SDL_FreeRW(context);
+    return 0;
+}
+
+static SDL_RWops* openCompressedEntry(const PackEntry& entry, const std::string& path)
+{
+    auto* stream = new MemoryStream;
+    stream->data.resize(entry.size);
+
+    if (!Compression::decompress(packData + entry.dataOffset, entry.storedSize, stream->data.data(), stream->data.size()))
+    {
+        delete stream;
+        SDL_SetError("Corrupt asset pack entry: %s", path.c_str());
+        return nullptr;
+    }
+
+    SDL_RWops* context = SDL_AllocRW();
+    if (context == nullptr)
+    {
+        delete stream;
+        return nullptr;
+    }
+
+    context->size = memoryStreamSize;
+    context->seek = memoryStreamSeek;
+    context->read = memoryStreamRead;
+    context->write = memoryStreamWrite;
+    context->close = memoryStreamClose;
+    context->type = SDL_RWOPS_UNKNOWN;
+    context->hidden.unknown.data1 = stream;
+    return context;
+}
+
+static void unmountPack()
+{
+    if (packData == nullptr) return;
+
+    if (packMapped)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(packData);
+        CloseHandle(packMapping);
+        packMapping = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(packData), packSize);
+#endif
+    }
+
+    packData = nullptr;
+    packMapped = false;
+    packSize = 0;
+    packEntries = nullptr;
+    packEntryCount = 0;
+}
+
+static bool mountPackData(const uint8_t* data, const size_t size, const bool mapped, const std::string& name)
+{
+    packData = data;
+    packSize = size;
+    packMapped = mapped;
+
+    PackHeader header;
+    bool valid = size >= sizeof(header);
+    if (valid)
+    {
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, packMagic, sizeof(packMagic)) == 0 && header.version == packVersion && header.entryCount <= (size - sizeof(header)) / sizeof(PackEntry);
+    }
+
+    if (valid)
+    {
+        packEntries = reinterpret_cast<const PackEntry*>(data + sizeof(header));
+        packEntryCount = header.entryCount;
+
+        for (uint32_t i = 0; i < packEntryCount && valid; i++)
+        {
+            const PackEntry& entry = packEntries[i];
+            // Checked without adding the offset, which could wrap. Uncompressed entries are opened with their size, so it has to match the stored data.
+            valid = entry.nameOffset + static_cast<uint64_t>(entry.nameLength) <= size && entry.dataOffset <= size && entry.storedSize <= size - entry.dataOffset;
+            valid = valid && ((entry.flags & packEntryCompressed) || entry.size == entry.storedSize);
+        }
+    }
+
+    if (!valid)
+    {
+        Log::write("Assets", LogLevel::error, "Invalid asset pack: %s", name.c_str());
+        unmountPack();
+        return false;
+    }
+
+    Log::write("Assets", LogLevel::info, "Mounted asset pack %s with %u files", name.c_str(), packEntryCount);
+    return true;
+}
+
+void Assets::init()
+{
+    // An embedded pack needs no file access at all, so ./assets.pack isn't even looked for.
+    if (embeddedPackData != nullptr)
+    {
+        mountPackData(embeddedPackData, embeddedPackSize, false, "embedded");
+        return;
+    }
+
+    if (std::filesystem::exists("./assets.pack"))
+    {
+        mountPack("./assets.pack");
+    }
+}
+
+SDL_RWops* Assets::open(const std::string& path)
+{
+    if (packData == nullptr || looseFileOverride)
+    {
+        const std::string loosePath = "./assets/" + path;
+        SDL_RWops* context = SDL_RWFromFile(loosePath.c_str(), "rb");
+        if (context != nullptr || packData == nullptr) return context;
+    }
+
+    const PackEntry* entry = findEntry(path);
+    if (entry == nullptr)
+    {
+        SDL_SetError("%s is not in the asset pack", path.c_str());
+        return nullptr;
+    }
+
+    if (entry->flags & packEntryCompressed)
+        return openCompressedEntry(*entry, path);
+
+    return SDL_RWFromConstMem(packData + entry->dataOffset, static_cast<int>(entry->size));
+}
+
+bool Assets::readFile(const std::string& path, std::string& contents)
+{
+    SDL_RWops* context = open(path);
+    if (context == nullptr) return false;
+
+    const Sint64 size = SDL_RWsize(context);
+    contents.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    const size_t read = contents.empty() ? 0 : SDL_RWread(context, contents.data(), contents.size(), 1);
+    SDL_RWclose(context);
+
+    return contents.empty() || read == 1;
+}
+
+bool Assets::isEmbedded()
+{
+    return packData != nullptr && packData == embeddedPackData;
+}
+
+bool Assets::exists(const std::string& path)
+{
+    if ((packData == nullptr || looseFileOverride) && std::filesystem::exists("./assets/" + path))
+        return true;
+
+    return findEntry(path) != nullptr;
+}
+
+void Assets::cleanUp()
+{
+    unmountPack();
+}
+
+bool Assets::mountPack(const std::string& path)
+{
+    unmountPack();
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        size = static_cast<size_t>(fileSize.QuadPart);
+
+        packMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (packMapping != nullptr)
+        {
+            data = static_cast<const uint8_t*>(MapViewOfFile(packMapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        CloseHandle(file);
+    }
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file != -1)
+    {
+        struct stat fileStat;
+        if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+        {
+            size = static_cast<size_t>(fileStat.st_size);
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+            data = mapping == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(mapping);
+        }
+        close(file);
+    }
+#endif
+
+    if (data == nullptr)
+    {
+        Log::write("Assets", LogLevel::error, "Can't map asset pack: %s", path.c_str());
+        return false;
+    }
+
+    return mountPackData(data, size, true, path);
+}
+
+void Assets::setEmbeddedPack(const void* data, const size_t size)
+{
+    embeddedPackData = static_cast<const uint8_t*>(data);
+    embeddedPackSize = size;
+}
+
+void Assets::setLooseFileOverride(const bool enabled)
+{
+    looseFileOverride = enabled;
+}
@@ -0,0 +1,140 @@
+#include "Compression.hpp"
+
+#include <cstring>
+#include <vector>
+
+// LZ77 in the LZ4 block layout: a token with the literal and match lengths, the literals,
+// a 16 bit match offset and length extensions in steps of 255.
+
+static constexpr int minMatch = 4;
+static constexpr int hashBits = 14;
+static constexpr size_t maxOffset = 65535;
+
+static uint32_t read32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint32_t hash(const uint32_t value)
+{
+    return value * 2654435761u >> (32 - hashBits);
+}
+
+static void writeLength(std::vector<uint8_t>& output, size_t length)
+{
+    for (; length >= 255; length -= 255)
+    {
+        output.push_back(255);
+    }
+    output.push_back(static_cast<uint8_t>(length));
+}
+
+static void writeSequence(std::vector<uint8_t>& output, const uint8_t* literals, const size_t literalLength, const size_t offset, const size_t matchLength)
+{
+    const size_t matchCode = matchLength > 0 ? matchLength - minMatch : 0;
+    output.push_back(static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4 | (matchCode < 15 ? matchCode : 15)));
+
+    if (literalLength >= 15) writeLength(output, literalLength - 15);
+    output.insert(output.end(), literals, literals + literalLength);
+
+    if (matchLength == 0) return;
+
+    output.push_back(static_cast<uint8_t>(offset));
+    output.push_back(static_cast<uint8_t>(offset >> 8));
+    if (matchCode >= 15) writeLength(output, matchCode - 15);
+}
+
+std::vector<uint8_t> Compression::compress(const uint8_t* data, const size_t size)
+{
+    std::vector<uint8_t> output;
+    output.reserve(size / 2);
+
+    std::vector<size_t> table(1 << hashBits, SIZE_MAX);
+    size_t anchor = 0;
+    size_t position = 0;
+
+    while (size >= minMatch && position <= size - minMatch)
+    {
+        const uint32_t sequence = read32(data + position);
+        const uint32_t key = hash(sequence);
+        const size_t candidate = table[key];
+        table[key] = position;
+
+        if (candidate == SIZE_MAX || position - candidate > maxOffset || read32(data + candidate) != sequence)
+        {
+            position++;
+            continue;
+        }
+
+        size_t matchLength = minMatch;
+        while (position + matchLength < size && data[candidate + matchLength] == data[position + matchLength])
+        {
+            matchLength++;
+        }
+
+        writeSequence(output, data + anchor, position - anchor, position - candidate, matchLength);
+        position += matchLength;
+        anchor = position;
+    }
+
+    writeSequence(output, data + anchor, size - anchor, 0, 0);
+    return output;
+}
+
+static bool readLength(const uint8_t*& source, const uint8_t* sourceEnd, size_t& length)
+{
+    uint8_t byte;
+    do
+    {
+        if (source >= sourceEnd) return false;
+        byte = *source++;
+        length += byte;
+    }
+    while (byte == 255);
+
+    return true;
+}
+
+bool Compression::decompress(const uint8_t* source, const size_t sourceSize, uint8_t* destination, const size_t destinationSize)
+{
+    const uint8_t* sourceEnd = source + sourceSize;
+    size_t written = 0;
+
+    while (source < sourceEnd)
+    {
+        const uint8_t token = *source++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(source, sourceEnd, literalLength)) return false;
+        if (literalLength > static_cast<size_t>(sourceEnd - source) || literalLength > destinationSize - written) return false;
+
+        memcpy(destination + written, source, literalLength);
+        source += literalLength;
+        written += literalLength;
+
+        // The last sequence only has literals.
+        if (source == sourceEnd) break;
+
+        if (sourceEnd - source < 2) return false;
+        const size_t offset = source[0] | source[1] << 8;
+        source += 2;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(source, sourceEnd, matchLength)) return false;
+        matchLength += minMatch;
+
+        if (offset == 0 || offset > written || matchLength > destinationSize - written) return false;
+
+        // Byte by byte, because a match may overlap the bytes it produces.
+        const uint8_t* match = destination + written - offset;
+        for (size_t i = 0; i < matchLength; i++)
+        {
+            destination[written + i] = match[i];
+        }
+        written += matchLength;
+    }
+
+    return written == destinationSize;
+}
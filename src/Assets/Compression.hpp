@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Compression
+{
+    std::vector<uint8_t> compress(const uint8_t* data, size_t size);
+    bool decompress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t destinationSize);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of an asset pack, all values are little endian:
+// PackHeader, entryCount PackEntry structs sorted by name, the names, then the file data.
+
+static constexpr char packMagic[4] = {'B', 'P', 'A', 'K'};
+static constexpr uint32_t packVersion = 1;
+
+static constexpr uint32_t packEntryCompressed = 1;
+
+struct PackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct PackEntry
+{
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint64_t dataOffset;
+    uint64_t storedSize;
+    uint64_t size;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PackHeader) == 16 && sizeof(PackEntry) == 40, "The pack layout must not contain padding");
@@ -0,0 +1,199 @@
+#include "Assets.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <SDL2/SDL.h>
+#include <nlohmann/json.hpp>
+
+#include "Audio.hpp"
+#include "Jobs.hpp"
+#include "Log.hpp"
+#include "Graphics/Renderer.hpp"
+#include "Graphics/SpriteSheet.hpp"
+
+using PreloadClock = std::chrono::steady_clock;
+
+struct PreloadedTexture
+{
+    std::string name;
+    PreloadClock::time_point requestTime;
+    PreloadClock::time_point loadTime;
+    bool loaded = false;
+};
+
+struct DecodedSound
+{
+    std::string name;
+    Mix_Chunk* sound = nullptr;
+    std::string error;
+    float loadTime = 0;
+};
+
+static float getMilliseconds(const PreloadClock::time_point start, const PreloadClock::time_point end)
+{
+    return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+static std::vector<std::string> getNames(const nlohmann::json& manifest, const char* key)
+{
+    std::vector<std::string> names;
+    if (!manifest.contains(key) || !manifest[key].is_array()) return names;
+
+    for (const nlohmann::json& name : manifest[key])
+    {
+        if (name.is_string()) names.push_back(name.get<std::string>());
+    }
+    return names;
+}
+
+static void requestTexture(const std::string& textureName, const std::string& path, std::vector<std::unique_ptr<PreloadedTexture>>& textures)
+{
+    textures.push_back(std::make_unique<PreloadedTexture>());
+    PreloadedTexture* texture = textures.back().get();
+    texture->name = textureName;
+    texture->requestTime = PreloadClock::now();
+
+    // Called right away if the texture is already loaded, otherwise once it has been decoded and uploaded.
+    Renderer::requestTexture(textureName, path, [texture](const TextureRegion&) {
+        texture->loadTime = PreloadClock::now();
+        texture->loaded = true;
+    });
+}
+
+bool Assets::preload(const std::string& manifestName)
+{
+    const PreloadClock::time_point start = PreloadClock::now();
+
+    std::string manifestFile;
+    if (!readFile("Manifests/" + manifestName + ".json", manifestFile))
+    {
+        Log::write("Assets", LogLevel::error, "Can't load manifest: %s / %s", manifestName.c_str(), SDL_GetError());
+        return false;
+    }
+
+    const nlohmann::json manifest = nlohmann::json::parse(manifestFile, nullptr, false);
+    if (!manifest.is_object())
+    {
+        Log::write("Assets", LogLevel::error, "Invalid manifest: %s", manifestName.c_str());
+        return false;
+    }
+
+    // Sounds are decoded as jobs while the main thread loads everything else.
+    // Without an audio device, as in headless mode, there is nothing to play them on.
+    std::vector<DecodedSound> sounds;
+    for (const std::string& soundName : Audio::isOpen() ? getNames(manifest, "sounds") : std::vector<std::string>())
+    {
+        if (!Audio::isSoundLoaded(soundName)) sounds.push_back({soundName});
+    }
+
+    std::vector<JobHandle> soundJobs;
+    for (DecodedSound& sound : sounds)
+    {
+        soundJobs.push_back(Jobs::run([&sound] {
+            const PreloadClock::time_point soundStart = PreloadClock::now();
+
+            sound.sound = Audio::decodeSound(sound.name);
+            if (sound.sound == nullptr) sound.error = SDL_GetError();
+            sound.loadTime = getMilliseconds(soundStart, PreloadClock::now());
+        }));
+    }
+
+    bool success = true;
+    int assetCount = 0;
+    std::vector<std::unique_ptr<PreloadedTexture>> textures;
+
+    for (const std::string& spriteName : getNames(manifest, "sprites"))
+    {
+        const PreloadClock::time_point spriteStart = PreloadClock::now();
+
+        // No sprite uses the sheet yet, so only its binary cache and its texture stay around. The texture budget may evict the texture again.
+        SpriteSheetCache::load(spriteName);
+        Log::write("Assets", LogLevel::info, "Preloaded %s sprite sheet in %.2f ms", spriteName.c_str(), getMilliseconds(spriteStart, PreloadClock::now()));
+        assetCount++;
+
+        requestTexture(spriteName, "Sprites/" + spriteName + ".png", textures);
+    }
+
+    for (const std::string& tilesetName : getNames(manifest, "tilesets"))
+    {
+        requestTexture(tilesetName, "Worlds/Tilesets/" + tilesetName + ".png", textures);
+    }
+
+    if (manifest.contains("fonts") && manifest["fonts"].is_array())
+    {
+        for (const nlohmann::json& fontJson : manifest["fonts"])
+        {
+            if (!fontJson.is_object() || !fontJson.contains("name") || !fontJson["name"].is_string() || !fontJson.contains("size") || !fontJson["size"].is_number_integer()) continue;
+
+            const std::string fontName = fontJson["name"].get<std::string>();
+            const int size = fontJson["size"].get<int>();
+            const PreloadClock::time_point fontStart = PreloadClock::now();
+
+            if (Renderer::loadFont(fontName, size) == nullptr)
+            {
+                success = false;
+                continue;
+            }
+
+            // Unreferenced fonts stay loaded until the font budget needs the memory.
+            Renderer::releaseFont(fontName, size);
+            Log::write("Assets", LogLevel::info, "Preloaded %s font with size %i in %.2f ms", fontName.c_str(), size, getMilliseconds(fontStart, PreloadClock::now()));
+            assetCount++;
+        }
+    }
+
+    for (const std::string& musicName : Audio::isOpen() ? getNames(manifest, "music") : std::vector<std::string>())
+    {
+        const PreloadClock::time_point musicStart = PreloadClock::now();
+
+        if (!Audio::loadMusic(musicName))
+        {
+            success = false;
+            continue;
+        }
+
+        Log::write("Assets", LogLevel::info, "Preloaded %s music in %.2f ms", musicName.c_str(), getMilliseconds(musicStart, PreloadClock::now()));
+        assetCount++;
+    }
+
+    Renderer::waitForTextures();
+
+    for (const std::unique_ptr<PreloadedTexture>& texture : textures)
+    {
+        if (!texture->loaded)
+        {
+            success = false;
+            continue;
+        }
+
+        // Unreferenced textures stay loaded until the texture budget needs the memory.
+        Renderer::releaseTexture(texture->name);
+        Log::write("Assets", LogLevel::info, "Preloaded %s texture in %.2f ms", texture->name.c_str(), getMilliseconds(texture->requestTime, texture->loadTime));
+        assetCount++;
+    }
+
+    for (const JobHandle& soundJob : soundJobs)
+    {
+        Jobs::wait(soundJob);
+    }
+
+    for (const DecodedSound& sound : sounds)
+    {
+        if (sound.sound == nullptr)
+        {
+            Log::write("Assets", LogLevel::error, "Can't load sound: %s / %s", sound.name.c_str(), sound.error.c_str());
+            success = false;
+            continue;
+        }
+
+        Audio::addSound(sound.name, sound.sound);
+        Log::write("Assets", LogLevel::info, "Preloaded %s sound in %.2f ms", sound.name.c_str(), sound.loadTime);
+        assetCount++;
+    }
+
+    Log::write("Assets", LogLevel::info, "Preloaded %i assets from %s manifest in %.2f ms", assetCount, manifestName.c_str(), getMilliseconds(start, PreloadClock::now()));
+    return success;
+}
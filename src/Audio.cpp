@@ -1,15 +1,49 @@
 #include "Audio.hpp"
 
-#include <unordered_map>
 #include <string>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_mixer.h>
 
+#include "Assets.hpp"
 #include "Log.hpp"
+#include "ResourceCache.hpp"
 
-static std::unordered_map<std::string, Mix_Music*> musicMap;
-static std::unordered_map<std::string, Mix_Chunk*> soundMap;
+static Mix_Music* currentMusic = nullptr;
+// Audio stays closed in headless mode, every function is a no-op then.
+static bool audioOpen = false;
+
+static void unloadMusic(const std::string& musicName, Mix_Music* music)
+{
+    Log::write("Audio", LogLevel::info, "Unloaded %s music", musicName.c_str());
+    if (music == currentMusic) currentMusic = nullptr;
+    Mix_FreeMusic(music);
+}
+
+static void unloadSound(const std::string& soundName, Mix_Chunk* sound)
+{
+    Log::write("Audio", LogLevel::info, "Unloaded %s sound", soundName.c_str());
+    Mix_FreeChunk(sound);
+}
+
+// Music and sounds are in use while they are playing.
+static bool isMusicPlaying(Mix_Music* music)
+{
+    return music == currentMusic && Mix_PlayingMusic();
+}
+
+static bool isSoundPlaying(Mix_Chunk* sound)
+{
+    const int channels = Mix_AllocateChannels(-1);
+    for (int channel = 0; channel < channels; channel++)
+    {
+        if (Mix_Playing(channel) && Mix_GetChunk(channel) == sound) return true;
+    }
+    return false;
+}
+
+static ResourceCache<std::string, Mix_Music*> musicCache(unloadMusic, isMusicPlaying);
+static ResourceCache<std::string, Mix_Chunk*> soundCache(unloadSound, isSoundPlaying);
 
 void Audio::init()
 {
@@ -31,24 +65,35 @@ void Audio::init()
         exit(EXIT_FAILURE);
     }
 
+    audioOpen = true;
     Log::write("Audio", LogLevel::info, "Initialized audio engine");
 }
 
+bool Audio::isOpen()
+{
+    return audioOpen;
+}
+
 bool Audio::loadMusic(const std::string& musicName)
 {
-    if (musicMap.contains(musicName))
+    if (!audioOpen) return false;
+
+    if (musicCache.find(musicName))
         return true;
 
-    const std::string fileName = "./assets/Music/" + musicName + ".ogg";
+    // Music is streamed from the file, so SDL_mixer closes it with the music.
+    SDL_RWops* file = Assets::open("Music/" + musicName + ".ogg");
+    const Sint64 fileSize = file ? SDL_RWsize(file) : 0;
 
-    if (Mix_Music* music = Mix_LoadMUS(fileName.c_str()); music == nullptr)
+    if (Mix_Music* music = file ? Mix_LoadMUS_RW(file, 1) : nullptr; music == nullptr)
     {
         Log::write("Audio", LogLevel::error, "Can't load music: %s / %s", musicName.c_str(), SDL_GetError());
         return false;
     }
     else
     {
-        musicMap.insert({musicName, music});
+        // The size of the file is the upper bound of what stays in memory.
+        musicCache.insert(musicName, music, fileSize > 0 ? static_cast<size_t>(fileSize) : 0);
     }
 
     Log::write("Audio", LogLevel::info, "Loaded %s music", musicName.c_str());
@@ -57,47 +102,75 @@ bool Audio::loadMusic(const std::string& musicName)
 
 void Audio::playMusic(const std::string& musicName, const int loops)
 {
-    if (!musicMap.contains(musicName) && !loadMusic(musicName))
+    if (!audioOpen) return;
+
+    if (!loadMusic(musicName))
     {
         return;
     }
 
-    Mix_PlayMusic(musicMap.at(musicName), loops);
+    currentMusic = *musicCache.find(musicName);
+    Mix_PlayMusic(currentMusic, loops);
 }
 
 void Audio::stopMusic()
 {
+    if (!audioOpen) return;
+
     Mix_HaltMusic();
 }
 
+bool Audio::isSoundLoaded(const std::string& soundName)
+{
+    return soundCache.contains(soundName);
+}
+
+// Doesn't touch the cache or the log, so sounds can be decoded on other threads.
+Mix_Chunk* Audio::decodeSound(const std::string& soundName)
+{
+    return Mix_LoadWAV_RW(Assets::open("SFX/" + soundName + ".ogg"), 1);
+}
+
+void Audio::addSound(const std::string& soundName, Mix_Chunk* sound)
+{
+    if (soundCache.contains(soundName))
+    {
+        Mix_FreeChunk(sound);
+        return;
+    }
+
+    soundCache.insert(soundName, sound, sizeof(Mix_Chunk) + sound->alen);
+    Log::write("Audio", LogLevel::info, "Loaded %s sound", soundName.c_str());
+}
+
 bool Audio::loadSound(const std::string& soundName)
 {
-    if (soundMap.contains(soundName))
+    if (!audioOpen) return false;
+
+    if (soundCache.find(soundName))
         return true;
 
-    const std::string fileName = "./assets/SFX/" + soundName + ".ogg";
-    if (Mix_Chunk* sound = Mix_LoadWAV(fileName.c_str()); sound == nullptr)
+    Mix_Chunk* sound = decodeSound(soundName);
+    if (sound == nullptr)
     {
         Log::write("Audio", LogLevel::error, "Can't load sound: %s / %s", soundName.c_str(), SDL_GetError());
         return false;
     }
-    else
-    {
-        soundMap.insert({soundName, sound});
-    }
 
-    Log::write("Audio", LogLevel::info, "Loaded %s sound", soundName.c_str());
+    addSound(soundName, sound);
     return true;
 }
 
 int Audio::playSound(const std::string& soundName)
 {
-    if (!soundMap.contains(soundName) && !loadSound(soundName))
+    if (!audioOpen) return -1;
+
+    if (!loadSound(soundName))
     {
         return -1;
     }
 
-    const int channel = Mix_PlayChannel(-1, soundMap.at(soundName), 0);
+    const int channel = Mix_PlayChannel(-1, *soundCache.find(soundName), 0);
     if (channel == -1)
     {
         Log::write("Audio", LogLevel::warning, "Can't play sound: %s", SDL_GetError());
@@ -107,32 +180,45 @@ int Audio::playSound(const std::string& soundName)
 
 void Audio::stopSound(const int channel)
 {
+    if (!audioOpen) return;
+
     Mix_HaltChannel(channel);
 }
 
 void Audio::unloadAllMusic()
 {
-    for (const auto& [musicName, music] : musicMap)
-    {
-        Log::write("Audio", LogLevel::info, "Unloaded %s music", musicName.c_str());
-        Mix_FreeMusic(music);
-    }
-    musicMap.clear();
+    musicCache.clear();
 }
 
 void Audio::unloadAllSounds()
 {
-    for (const auto& [soundName, sound] : soundMap)
-    {
-        Log::write("Audio", LogLevel::info, "Unloaded %s sound", soundName.c_str());
-        Mix_FreeChunk(sound);
-    }
-    soundMap.clear();
+    soundCache.clear();
+}
+
+size_t Audio::getMusicMemory()
+{
+    return musicCache.getResidentBytes();
+}
+
+size_t Audio::getSoundMemory()
+{
+    return soundCache.getResidentBytes();
+}
+
+void Audio::setMusicBudget(const size_t bytes)
+{
+    musicCache.setBudget(bytes);
+}
+
+void Audio::setSoundBudget(const size_t bytes)
+{
+    soundCache.setBudget(bytes);
 }
 
 void Audio::cleanUp()
 {
     unloadAllMusic();
     unloadAllSounds();
-    Mix_CloseAudio();
+    if (audioOpen) Mix_CloseAudio();
+    audioOpen = false;
 }
\ No newline at end of file
@@ -1,8 +1,17 @@
 #include "Bee.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <SDL2/SDL.h>
 
+#include "Assets.hpp"
 #include "Audio.hpp"
+#include "Jobs.hpp"
 #include "Log.hpp"
 #include "Graphics/Renderer.hpp"
 #include "Input/Controller.hpp"
@@ -12,17 +21,46 @@
 
 static void (*initFunc)() = nullptr;
 static bool initialized = false;
+static bool headless = false;
 static bool gameRunning = false;
 static float deltaTime = 0;
 static uint32_t currentTime = 0;
-static Uint64 loopTicks = 0;
-static Uint64 loopTicksLast = 0;
+static std::chrono::steady_clock::time_point startTime;
+static uint64_t frameTime = 0;
+// The game clock continues from where stepping left it, ahead of or behind the real clock.
+static int64_t clockOffset = 0;
+static bool stepping = false;
+static uint64_t steppedTime = 0;
+// 0 updates the world once per frame with a variable delta time.
+static float tickRate = 0;
+static int maxTicksPerFrame = 8;
+static uint64_t tickAccumulator = 0;
+static float interpolationAlpha = 1;
+static bool pipelinedRendering = false;
+static std::thread simulationThread;
+static std::mutex simulationMutex;
+static std::condition_variable simulationCondition;
+static bool simulationRequested = false;
+static bool simulationStopping = false;
+static uint64_t simulationElapsedTime = 0;
+// 0 leaves the frame rate to vsync.
+static float targetFrameRate = 0;
+static float backgroundFrameRate = 10;
+// Unfocused windows are often still watched, e.g. next to an editor, so they aren't throttled unless asked for.
+static float unfocusedFrameRate = 0;
+static uint64_t nextFrameDeadline = 0;
+static bool windowVisible = true;
+static bool windowFocused = true;
+static float averageFrameTime = 0;
+static float frameTimeJitter = 0;
 static World* nextWorld = nullptr;
+static World* preparingWorld = nullptr;
 static World* currentWorld = nullptr;
 
 void Bee::init(const int windowWidth, const int windowHeight)
 {
     atexit(cleanUp);
+    startTime = std::chrono::steady_clock::now();
 
     if (SDL_Init(0) < 0)
     {
@@ -31,9 +69,15 @@ void Bee::init(const int windowWidth, const int windowHeight)
     }
     Log::write("Engine", LogLevel::info, "Initialized SDL2");
 
-    Renderer::init(windowWidth, windowHeight);
-    Audio::init();
-    Controller::init();
+    Assets::init();
+
+    // Headless mode needs no display, audio device or controllers. Input can be set through Keyboard and Mouse.
+    Renderer::init(windowWidth, windowHeight, headless);
+    if (!headless)
+    {
+        Audio::init();
+        Controller::init();
+    }
     Keyboard::init();
     Mouse::init();
 
@@ -48,16 +92,170 @@ void Bee::init(const int windowWidth, const int windowHeight)
     initialized = true;
 }
 
+void Bee::setHeadless(const bool enabled)
+{
+    if (initialized)
+    {
+        Log::write("Engine", LogLevel::warning, "Headless mode has to be set before the engine is initialized");
+        return;
+    }
+    headless = enabled;
+}
+
+bool Bee::isHeadless()
+{
+    return headless;
+}
+
 void Bee::onInit(void (*func)())
 {
     initFunc = func;
 }
 
-static void mainLoop()
+static void tick()
+{
+    currentWorld->update();
+    currentWorld->updateEntities();
+
+    // Input is advanced per tick, so a press in a frame without a tick is still seen by the next tick.
+    Controller::update();
+    Keyboard::update();
+    Mouse::update();
+}
+
+// Sleeps until the next frame is due. The last few milliseconds are spun, sleeping isn't precise enough to hit the deadline.
+static void paceFrame()
 {
-    loopTicksLast = loopTicks;
-    loopTicks = SDL_GetPerformanceCounter();
-    currentTime = SDL_GetTicks();
+    float frameRate = targetFrameRate;
+    const float throttledFrameRate = !windowVisible ? backgroundFrameRate : !windowFocused ? unfocusedFrameRate : 0;
+    if (throttledFrameRate > 0)
+    {
+        frameRate = frameRate > 0 ? std::min(frameRate, throttledFrameRate) : throttledFrameRate;
+    }
+
+    if (frameRate <= 0)
+    {
+        nextFrameDeadline = 0;
+        return;
+    }
+
+    constexpr uint64_t spinTime = 2000000;
+    const uint64_t frameDuration = static_cast<uint64_t>(1000000000.0 / frameRate);
+    uint64_t now = Bee::getTimeNanoseconds();
+
+    // A frame that ran more than a frame late starts a new schedule instead of rushing the following frames.
+    if (nextFrameDeadline == 0 || now > nextFrameDeadline + frameDuration)
+    {
+        nextFrameDeadline = now;
+    }
+
+    while (now < nextFrameDeadline)
+    {
+        const uint64_t remainingTime = nextFrameDeadline - now;
+        if (remainingTime > spinTime)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(remainingTime - spinTime));
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+        now = Bee::getTimeNanoseconds();
+    }
+
+    nextFrameDeadline += frameDuration;
+}
+
+static void measureFrameTime(const uint64_t elapsedTime)
+{
+    const float elapsedMilliseconds = static_cast<float>(elapsedTime) / 1000000.0f;
+
+    if (averageFrameTime == 0)
+    {
+        averageFrameTime = elapsedMilliseconds;
+        return;
+    }
+
+    // Moving averages over roughly the last 20 frames.
+    averageFrameTime += (elapsedMilliseconds - averageFrameTime) * 0.05f;
+    frameTimeJitter += (std::abs(elapsedMilliseconds - averageFrameTime) - frameTimeJitter) * 0.05f;
+}
+
+static void handleWindowEvent(const SDL_Event* event)
+{
+    switch (event->window.event)
+    {
+        case SDL_WINDOWEVENT_MINIMIZED: case SDL_WINDOWEVENT_HIDDEN:
+            windowVisible = false;
+            break;
+        case SDL_WINDOWEVENT_RESTORED: case SDL_WINDOWEVENT_MAXIMIZED: case SDL_WINDOWEVENT_SHOWN: case SDL_WINDOWEVENT_EXPOSED:
+            windowVisible = true;
+            break;
+        case SDL_WINDOWEVENT_FOCUS_GAINED:
+            windowFocused = true;
+            break;
+        case SDL_WINDOWEVENT_FOCUS_LOST:
+            windowFocused = false;
+            break;
+        default:
+            break;
+    }
+}
+
+static void simulate(const uint64_t elapsedTime)
+{
+    if (tickRate > 0)
+    {
+        const uint64_t tickDuration = static_cast<uint64_t>(1000000000.0 / tickRate);
+        deltaTime = static_cast<float>(tickDuration) / 1000000000.0f;
+
+        // Time that would need more ticks than allowed is dropped, so a slow frame can't make the next one even slower.
+        tickAccumulator = std::min(tickAccumulator + elapsedTime, tickDuration * maxTicksPerFrame);
+        while (tickAccumulator >= tickDuration)
+        {
+            tickAccumulator -= tickDuration;
+            tick();
+        }
+
+        // The leftover time places the rendered frame between the last two ticks.
+        interpolationAlpha = static_cast<float>(tickAccumulator) / static_cast<float>(tickDuration);
+    }
+    else
+    {
+        deltaTime = static_cast<float>(elapsedTime) / 1000000000.0f;
+        interpolationAlpha = 1;
+        tick();
+    }
+}
+
+
+static void runSimulationThread()
+{
+    while (true)
+    {
+        uint64_t elapsedTime;
+        {
+            std::unique_lock lock(simulationMutex);
+            simulationCondition.wait(lock, [] { return simulationRequested || simulationStopping; });
+
+            if (simulationStopping) return;
+
+            simulationRequested = false;
+            elapsedTime = simulationElapsedTime;
+        }
+
+        simulate(elapsedTime);
+        Renderer::endSimulation();
+    }
+}
+
+static void switchWorld()
+{
+    if (preparingWorld && preparingWorld->isPrepared())
+    {
+        nextWorld = preparingWorld;
+        preparingWorld = nullptr;
+    }
 
     if (nextWorld)
     {
@@ -66,6 +264,42 @@ static void mainLoop()
         nextWorld = nullptr;
         currentWorld->onLoad();
     }
+}
+
+static bool loadFirstWorld()
+{
+    if (currentWorld) return true;
+
+    // Nothing is running yet, so a world that is still being prepared finishes loading in onLoad.
+    if (!nextWorld)
+    {
+        nextWorld = preparingWorld;
+        preparingWorld = nullptr;
+    }
+
+    if (!nextWorld)
+    {
+        Log::write("Engine", LogLevel::error, "No world loaded");
+        return false;
+    }
+
+    currentWorld = nextWorld;
+    nextWorld = nullptr;
+    currentWorld->onLoad();
+    return true;
+}
+
+static void mainLoop()
+{
+    paceFrame();
+
+    const uint64_t frameTimeLast = frameTime;
+    frameTime = Bee::getTimeNanoseconds();
+    const uint64_t elapsedTime = frameTime - frameTimeLast;
+    if (frameTimeLast != 0) measureFrameTime(elapsedTime);
+    currentTime = static_cast<uint32_t>(frameTime / 1000000);
+
+    switchWorld();
 
     SDL_Event event;
     while (SDL_PollEvent(&event))
@@ -91,6 +325,7 @@ static void mainLoop()
                 Mouse::handleMovement(&event);
                 break;
             case SDL_WINDOWEVENT:
+                handleWindowEvent(&event);
                 Renderer::handleEvent(&event);
                 break;
             case SDL_QUIT:
@@ -101,14 +336,48 @@ static void mainLoop()
         }
     }
 
-    Renderer::update();
-    currentWorld->update();
-    currentWorld->updateInternal();
-    Controller::update();
-    Keyboard::update();
-    Mouse::update();
+    if (pipelinedRendering)
+    {
+        // The next frame is simulated while the frame recorded last is presented.
+        if (!simulationThread.joinable())
+        {
+            simulationStopping = false;
+            simulationThread = std::thread(runSimulationThread);
+        }
+
+        Renderer::beginSimulation();
+        {
+            std::lock_guard lock(simulationMutex);
+            simulationElapsedTime = elapsedTime;
+            simulationRequested = true;
+        }
+        simulationCondition.notify_one();
+
+        if (windowVisible) Renderer::present();
+        Renderer::waitForSimulation();
+        Renderer::uploadTextures();
+    }
+    else
+    {
+        if (windowVisible) Renderer::present();
+        Renderer::uploadTextures();
+        simulate(elapsedTime);
+    }
 
-    deltaTime = static_cast<float>(loopTicks - loopTicksLast) / SDL_GetPerformanceFrequency();
+    // Nothing is drawn while the window can't be seen. Entities are only read for drawing while the simulation is idle.
+    if (windowVisible) currentWorld->updateInternal();
+}
+
+static void stopSimulationThread()
+{
+    if (!simulationThread.joinable()) return;
+
+    {
+        std::lock_guard lock(simulationMutex);
+        simulationStopping = true;
+    }
+    simulationCondition.notify_one();
+    simulationThread.join();
 }
 
 void Bee::run()
@@ -118,21 +387,16 @@ void Bee::run()
         init(1280, 720);
     }
 
-    if (!nextWorld)
-    {
-        Log::write("Engine", LogLevel::error, "No world loaded");
-        return;
-    }
+    if (!loadFirstWorld()) return;
 
-    currentWorld = nextWorld;
-    nextWorld = nullptr;
     gameRunning = true;
-    currentWorld->onLoad();
+    frameTime = getTimeNanoseconds();
 
     while (gameRunning)
     {
         mainLoop();
     }
+    stopSimulationThread();
     currentWorld->onUnload();
 }
 
@@ -156,16 +420,132 @@ uint32_t Bee::getTime()
     return currentTime;
 }
 
+uint64_t Bee::getTimeNanoseconds()
+{
+    if (stepping) return steppedTime;
+
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count() + clockOffset);
+}
+
+float Bee::getInterpolationAlpha()
+{
+    return interpolationAlpha;
+}
+
+void Bee::setTargetFrameRate(const float framesPerSecond)
+{
+    targetFrameRate = framesPerSecond;
+    nextFrameDeadline = 0;
+}
+
+void Bee::setBackgroundFrameRate(const float framesPerSecond)
+{
+    backgroundFrameRate = framesPerSecond;
+    nextFrameDeadline = 0;
+}
+
+void Bee::setUnfocusedFrameRate(const float framesPerSecond)
+{
+    unfocusedFrameRate = framesPerSecond;
+    nextFrameDeadline = 0;
+}
+
+float Bee::getAverageFrameTime()
+{
+    return averageFrameTime;
+}
+
+float Bee::getFrameTimeJitter()
+{
+    return frameTimeJitter;
+}
+
+void Bee::setPipelinedRendering(const bool enabled)
+{
+    pipelinedRendering = enabled;
+}
+
+void Bee::step(const int ticks)
+{
+    if (!initialized)
+    {
+        init(1280, 720);
+    }
+
+    // The virtual clock starts at the last frame, or at 0 before the first one, so the result doesn't depend on when step is called.
+    steppedTime = frameTime;
+    currentTime = static_cast<uint32_t>(steppedTime / 1000000);
+    stepping = true;
+
+    if (!loadFirstWorld())
+    {
+        stepping = false;
+        return;
+    }
+
+    // Without a tick rate, a step is as long as a frame at 60 frames per second.
+    const uint64_t tickDuration = static_cast<uint64_t>(1000000000.0 / (tickRate > 0 ? tickRate : 60));
+
+    for (int i = 0; i < ticks; i++)
+    {
+        // Loading finishes before every tick, so the result doesn't depend on how fast assets are decoded.
+        while (preparingWorld && !preparingWorld->isPrepared())
+        {
+            Renderer::waitForTextures();
+            std::this_thread::yield();
+        }
+        switchWorld();
+        Renderer::waitForTextures();
+
+        steppedTime += tickDuration;
+        currentTime = static_cast<uint32_t>(steppedTime / 1000000);
+        deltaTime = static_cast<float>(tickDuration) / 1000000000.0f;
+        interpolationAlpha = 1;
+
+        tick();
+        currentWorld->updateAnimations();
+    }
+
+    stepping = false;
+
+    // The stepped time isn't simulated again by the next frame, and the next step continues where this one stopped.
+    clockOffset += static_cast<int64_t>(steppedTime) - static_cast<int64_t>(getTimeNanoseconds());
+    frameTime = steppedTime;
+    tickAccumulator = 0;
+    nextFrameDeadline = 0;
+}
+
+void Bee::setTickRate(const float ticksPerSecond)
+{
+    tickRate = std::max(ticksPerSecond, 0.0f);
+    tickAccumulator = 0;
+}
+
+void Bee::setMaxTicksPerFrame(const int ticks)
+{
+    maxTicksPerFrame = std::max(ticks, 1);
+}
+
 void Bee::setWorld(World* world)
 {
     nextWorld = world;
+    preparingWorld = nullptr;
+}
+
+void Bee::prepareWorld(World* world)
+{
+    preparingWorld = world;
+    world->onPrepare();
 }
 
 void Bee::cleanUp()
 {
     Audio::cleanUp();
+    // Image decoding stops with the renderer, so the workers don't decode images nobody needs anymore. Jobs read assets, so they stop before the pack is unmapped.
     Renderer::cleanUp();
+    Jobs::shutdown();
     Controller::cleanUp();
     Mouse::cleanUp();
+    Assets::cleanUp();
     SDL_Quit();
 }
\ No newline at end of file
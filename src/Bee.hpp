@@ -29,6 +29,20 @@ namespace Bee
      */
     World* getCurrentWorld();
 
+    /**
+     * @brief Run without a window, renderer output, audio device or controllers, e.g. for automated tests, benchmarks or servers. Draws are only counted and audio functions do nothing. Input can be set with Keyboard::setKeyDown and the Mouse functions. Has to be called before the engine is initialized.
+     * 
+     * @param enabled whether the engine runs headless
+     */
+    void setHeadless(bool enabled);
+
+    /**
+     * @brief Check if the engine runs headless.
+     * 
+     * @return true if there is no window and no audio, false otherwise.
+     */
+    bool isHeadless();
+
     /**
      * @brief Set the current world.
      * 
@@ -36,10 +50,17 @@ namespace Bee
      */
     void setWorld(World* world);
 
+    /**
+     * @brief Stage the next world while the current world keeps running. onPrepare of the world is called right away, and the world becomes the current world once everything it prepared is loaded.
+     * 
+     * @param world the pointer to the world
+     */
+    void prepareWorld(World* world);
+
     /**
      * @brief Get the delta time
      * 
-     * @return the time in seconds it took for a frame to render. Used to make sure that everything moves at the same speed.
+     * @return the time in seconds it took for a frame to render, or the duration of a tick in fixed timestep mode. Used to make sure that everything moves at the same speed.
      */
     float getDeltaTime();
 
@@ -49,4 +70,84 @@ namespace Bee
      * @return the the time in millisconds since the engine was initialized.
      */
     uint32_t getTime();
+
+    /**
+     * @brief Get the time passed since the start of the game with nanosecond resolution.
+     * 
+     * @return the time in nanoseconds since the engine was initialized, from a monotonic clock.
+     */
+    uint64_t getTimeNanoseconds();
+
+    /**
+     * @brief Get how far the rendered frame is between the last two ticks in fixed timestep mode. Entities are drawn at their position interpolated by this value.
+     * 
+     * @return a value from 0 to 1, always 1 without a fixed timestep.
+     */
+    float getInterpolationAlpha();
+
+    /**
+     * @brief Update the world at a fixed rate instead of once per frame. Frames between ticks draw entities interpolated between their last two positions, Entity::skipInterpolation turns that off for a teleported entity. Disabled by default.
+     * 
+     * @param ticksPerSecond the number of updates per second, 0 to update once per frame
+     */
+    void setTickRate(float ticksPerSecond);
+
+    /**
+     * @brief Set the maximum number of ticks per frame in fixed timestep mode. Time beyond that is dropped, so the game slows down instead of falling further behind. Defaults to 8.
+     * 
+     * @param ticks the maximum number of ticks per frame
+     */
+    void setMaxTicksPerFrame(int ticks);
+
+    /**
+     * @brief Advance the current world by a number of ticks as fast as possible, without drawing or waiting for vsync, e.g. for automated tests or AI tuning. A virtual clock drives getTime, getDeltaTime and animations, so the same inputs always give the same results. Every tick lasts 1 / tick rate seconds, or 1 / 60 seconds without a fixed tick rate. Assets that are still loading are waited for before each tick.
+     * 
+     * The virtual clock starts at the time of the last frame, or at 0 before the first frame, also for onLoad of the first world, and the game clock continues from where it stopped afterwards.
+     * Thread safe entities are only deterministic as long as they read other entities and the world the way setThreadSafe allows, since they are updated in no particular order.
+     * 
+     * @param ticks the number of ticks to run
+     */
+    void step(int ticks);
+
+    /**
+     * @brief Limit the frame rate. The main loop sleeps until shortly before the next frame is due and waits out the rest precisely. Disabled by default, leaving the frame rate to vsync.
+     * 
+     * @param framesPerSecond the maximum number of frames per second, 0 for no limit
+     */
+    void setTargetFrameRate(float framesPerSecond);
+
+    /**
+     * @brief Set the frame rate while the window is minimized or hidden. Nothing is drawn while the window is minimized or hidden, the world is still updated. Defaults to 10.
+     * 
+     * @param framesPerSecond the maximum number of frames per second in the background, 0 to keep the normal frame rate
+     */
+    void setBackgroundFrameRate(float framesPerSecond);
+
+    /**
+     * @brief Set the frame rate while the window is visible but not focused. Disabled by default, since an unfocused window may still be watched.
+     * 
+     * @param framesPerSecond the maximum number of frames per second while unfocused, 0 to keep the normal frame rate
+     */
+    void setUnfocusedFrameRate(float framesPerSecond);
+
+    /**
+     * @brief Get the average time between frames.
+     * 
+     * @return the moving average of the frame time over the last frames in milliseconds.
+     */
+    float getAverageFrameTime();
+
+    /**
+     * @brief Get how much the frame time varies, e.g. to detect stutter.
+     * 
+     * @return the moving average of the difference between the frame time and the average frame time in milliseconds.
+     */
+    float getFrameTimeJitter();
+
+    /**
+     * @brief Simulate the next frame on a separate thread while the current one is presented. Entities must not touch the renderer outside of drawing, SDL calls from the simulation are run on the main thread. Disabled by default.
+     * 
+     * @param enabled whether rendering is pipelined
+     */
+    void setPipelinedRendering(bool enabled);
 };
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include "Collision.hpp"
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
+#include <cstdint>
 #include <vector>
 
 #include "Math/Vector2f.hpp"
@@ -172,4 +174,279 @@ bool Collision::checkCollision(const Hitbox& hitbox1, const Hitbox& hitbox2, Int
         expandingPolytopeAlgorithm(intersection, simplex, hitbox1, hitbox2);
         return true;
     }
+}
+
+float crossProduct(const Vector2f& a, const Vector2f& b, const Vector2f& c)
+{
+    return (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+}
+
+bool isConvex(const std::vector<Vector2f>& polygon)
+{
+    for (size_t i = 0; i < polygon.size(); i++)
+    {
+        if (crossProduct(polygon[i], polygon[(i + 1) % polygon.size()], polygon[(i + 2) % polygon.size()]) < 0)
+            return false;
+    }
+    return true;
+}
+
+bool isInTriangle(const Vector2f& point, const Vector2f& a, const Vector2f& b, const Vector2f& c)
+{
+    return crossProduct(a, b, point) >= 0 && crossProduct(b, c, point) >= 0 && crossProduct(c, a, point) >= 0;
+}
+
+bool mergePolygons(const std::vector<Vector2f>& polygon1, const std::vector<Vector2f>& polygon2, std::vector<Vector2f>& merged)
+{
+    for (size_t i = 0; i < polygon1.size(); i++)
+    {
+        const Vector2f& start = polygon1[i];
+        const Vector2f& end = polygon1[(i + 1) % polygon1.size()];
+
+        for (size_t j = 0; j < polygon2.size(); j++)
+        {
+            if (!(polygon2[j] == end && polygon2[(j + 1) % polygon2.size()] == start)) continue;
+
+            merged.clear();
+            for (size_t k = 1; k <= polygon1.size(); k++)
+            {
+                merged.push_back(polygon1[(i + k) % polygon1.size()]);
+            }
+            for (size_t k = 2; k < polygon2.size(); k++)
+            {
+                merged.push_back(polygon2[(j + k) % polygon2.size()]);
+            }
+            return isConvex(merged);
+        }
+    }
+    return false;
+}
+
+std::vector<std::vector<Vector2f>> Collision::decomposeConvex(const std::vector<Vector2f>& polygon)
+{
+    std::vector<Vector2f> points;
+
+    for (size_t i = 0; i < polygon.size(); i++)
+    {
+        if (points.empty() || !(points.back() == polygon[i]))
+            points.push_back(polygon[i]);
+    }
+    while (points.size() > 1 && points.front() == points.back())
+    {
+        points.pop_back();
+    }
+
+    for (size_t i = 0; points.size() > 3 && i < points.size();)
+    {
+        const size_t previous = (i + points.size() - 1) % points.size();
+        const size_t next = (i + 1) % points.size();
+        if (fabsf(crossProduct(points[previous], points[i], points[next])) < 0.000001f)
+        {
+            points.erase(points.begin() + i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if (points.size() <= 3) return {points};
+
+    float area = 0;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        const Vector2f& next = points[(i + 1) % points.size()];
+        area += points[i].x * next.y - next.x * points[i].y;
+    }
+    if (area < 0)
+    {
+        std::reverse(points.begin(), points.end());
+    }
+
+    if (isConvex(points)) return {points};
+
+    // Ear clipping followed by Hertel-Mehlhorn merging of the triangles.
+    std::vector<std::vector<Vector2f>> parts;
+    std::vector<Vector2f> remaining = points;
+
+    while (remaining.size() > 3)
+    {
+        bool earFound = false;
+
+        for (size_t i = 0; i < remaining.size(); i++)
+        {
+            const Vector2f& previous = remaining[(i + remaining.size() - 1) % remaining.size()];
+            const Vector2f& current = remaining[i];
+            const Vector2f& next = remaining[(i + 1) % remaining.size()];
+
+            if (crossProduct(previous, current, next) <= 0) continue;
+
+            bool isEar = true;
+            for (const Vector2f& point : remaining)
+            {
+                if (point == previous || point == current || point == next) continue;
+                if (isInTriangle(point, previous, current, next))
+                {
+                    isEar = false;
+                    break;
+                }
+            }
+
+            if (!isEar) continue;
+
+            parts.push_back({previous, current, next});
+            remaining.erase(remaining.begin() + i);
+            earFound = true;
+            break;
+        }
+
+        if (!earFound) break;
+    }
+    parts.push_back(remaining);
+
+    std::vector<Vector2f> merged;
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        for (size_t j = i + 1; j < parts.size(); j++)
+        {
+            if (mergePolygons(parts[i], parts[j], merged))
+            {
+                parts[i] = merged;
+                parts.erase(parts.begin() + j);
+                j = i;
+            }
+        }
+    }
+
+    return parts;
+}
+
+void Collision::getBounds(const Hitbox& hitbox, Vector2f& min, Vector2f& max)
+{
+    if (hitbox.isEllipse)
+    {
+        min = hitbox.center - hitbox.ellipse;
+        max = hitbox.center + hitbox.ellipse;
+        return;
+    }
+
+    min = {FLT_MAX, FLT_MAX};
+    max = {-FLT_MAX, -FLT_MAX};
+
+    for (const Vector2f& vertex : hitbox.vertices)
+    {
+        min.x = std::min(min.x, vertex.x);
+        min.y = std::min(min.y, vertex.y);
+        max.x = std::max(max.x, vertex.x);
+        max.y = std::max(max.y, vertex.y);
+    }
+}
+
+bool getMaskBit(const CollisionMask& mask, const int x, const int y)
+{
+    if (x < 0 || y < 0 || x >= mask.width || y >= mask.height) return false;
+    return mask.bits[y * mask.wordsPerRow + x / 64] >> (x % 64) & 1;
+}
+
+uint64_t getMaskBits(const CollisionMask& mask, const int x, const int y)
+{
+    const uint64_t* row = &mask.bits[y * mask.wordsPerRow];
+    const int word = x / 64;
+    const int shift = x % 64;
+
+    uint64_t bits = row[word] >> shift;
+    if (shift != 0 && word + 1 < mask.wordsPerRow)
+    {
+        bits |= row[word + 1] << (64 - shift);
+    }
+    return bits;
+}
+
+bool Collision::checkMaskCollision(const CollisionMask* mask1, const Vector2f& position1, const Vector2f& size1, const CollisionMask* mask2, const Vector2f& position2, const Vector2f& size2)
+{
+    const float left = std::max(position1.x, position2.x);
+    const float right = std::min(position1.x + size1.x, position2.x + size2.x);
+    const float top = std::max(position1.y, position2.y);
+    const float bottom = std::min(position1.y + size1.y, position2.y + size2.y);
+
+    if (left >= right || top >= bottom) return false;
+    if (!mask1 && !mask2) return true;
+
+    if (!mask1)
+    {
+        return checkMaskCollision(mask2, position2, size2, mask1, position1, size1);
+    }
+
+    // Everything is done in the pixel grid of the first mask.
+    const float pixelsPerUnitX = mask1->width / size1.x;
+    const float pixelsPerUnitY = mask1->height / size1.y;
+
+    const int startX = std::max(0, static_cast<int>(floorf((left - position1.x) * pixelsPerUnitX)));
+    const int endX = std::min(mask1->width, static_cast<int>(ceilf((right - position1.x) * pixelsPerUnitX)));
+    const int startY = std::max(0, static_cast<int>(floorf((top - position1.y) * pixelsPerUnitY)));
+    const int endY = std::min(mask1->height, static_cast<int>(ceilf((bottom - position1.y) * pixelsPerUnitY)));
+
+    float pixelsPerUnitX2 = 0;
+    float pixelsPerUnitY2 = 0;
+    int offsetX = 0;
+    bool sameScale = true;
+
+    if (mask2)
+    {
+        pixelsPerUnitX2 = mask2->width / size2.x;
+        pixelsPerUnitY2 = mask2->height / size2.y;
+        offsetX = static_cast<int>(roundf((position1.x - position2.x) * pixelsPerUnitX));
+        sameScale = fabsf(pixelsPerUnitX - pixelsPerUnitX2) < 0.001f * pixelsPerUnitX;
+    }
+
+    for (int y = startY; y < endY; y++)
+    {
+        int y2 = 0;
+        int x = startX;
+        int rowEnd = endX;
+
+        if (mask2)
+        {
+            const float worldY = position1.y + (y + 0.5f) / pixelsPerUnitY;
+            y2 = static_cast<int>(floorf((worldY - position2.y) * pixelsPerUnitY2));
+            if (y2 < 0 || y2 >= mask2->height) continue;
+
+            if (sameScale)
+            {
+                x = std::max(x, -offsetX);
+                rowEnd = std::min(rowEnd, mask2->width - offsetX);
+            }
+        }
+
+        for (; x < rowEnd; x += 64)
+        {
+            const int count = std::min(64, rowEnd - x);
+            const uint64_t limit = count == 64 ? ~0ull : (1ull << count) - 1;
+            uint64_t bits = getMaskBits(*mask1, x, y) & limit;
+
+            if (!bits) continue;
+
+            if (!mask2) return true;
+
+            if (sameScale)
+            {
+                bits &= getMaskBits(*mask2, x + offsetX, y2);
+            }
+            else
+            {
+                uint64_t bits2 = 0;
+                for (int i = 0; i < count; i++)
+                {
+                    const float worldX = position1.x + (x + i + 0.5f) / pixelsPerUnitX;
+                    const int x2 = static_cast<int>(floorf((worldX - position2.x) * pixelsPerUnitX2));
+                    bits2 |= static_cast<uint64_t>(getMaskBit(*mask2, x2, y2)) << i;
+                }
+                bits &= bits2;
+            }
+
+            if (bits) return true;
+        }
+    }
+
+    return false;
 }
\ No newline at end of file
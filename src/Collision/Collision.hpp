@@ -1,9 +1,16 @@
 #pragma once
 
+#include <vector>
+
+#include "Collision/CollisionMask.hpp"
 #include "Collision/Hitbox.hpp"
 #include "Collision/Intersection.hpp"
+#include "Math/Vector2f.hpp"
 
 namespace Collision
 {
     bool checkCollision(const Hitbox& hitbox1, const Hitbox& hitbox2, Intersection& intersection);
+    std::vector<std::vector<Vector2f>> decomposeConvex(const std::vector<Vector2f>& polygon);
+    void getBounds(const Hitbox& hitbox, Vector2f& min, Vector2f& max);
+    bool checkMaskCollision(const CollisionMask* mask1, const Vector2f& position1, const Vector2f& size1, const CollisionMask* mask2, const Vector2f& position2, const Vector2f& size2);
 }
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct CollisionMask
+{
+    int width = 0;
+    int height = 0;
+    int wordsPerRow = 0;
+
+    std::vector<uint64_t> bits;
+};
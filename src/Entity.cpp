@@ -1,5 +1,6 @@
 #include "Entity.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -8,6 +9,7 @@
 #include "Collision/Collision.hpp"
 #include "Input/Mouse.hpp"
 #include "Math/Vector2f.hpp"
+#include "World/SpatialGrid.hpp"
 
 Entity::Entity()
 {
@@ -19,9 +21,32 @@ void Entity::update()
 
 }
 
-void Entity::updateInternal() const
+void Entity::updateInternal(const float interpolationAlpha) const
 {
-    sprite->updateInternalEntity(position, scale, rotationCenter, rotation);
+    if (interpolationAlpha >= 1 || interpolationSkipped)
+    {
+        sprite->updateInternalEntity(position, scale, rotationCenter, rotation);
+        return;
+    }
+
+    // Rotation is interpolated the short way around.
+    const float rotationOffset = std::remainder(rotation - previousRotation, 360.0f);
+    const Vector2f drawPosition = previousPosition + (position - previousPosition) * interpolationAlpha;
+    const float drawRotation = rotation - rotationOffset * (1 - interpolationAlpha);
+
+    sprite->updateInternalEntity(drawPosition, scale, rotationCenter, drawRotation);
+}
+
+void Entity::updateAnimation() const
+{
+    sprite->updateAnimation();
+}
+
+void Entity::savePreviousTransform()
+{
+    previousPosition = position;
+    previousRotation = rotation;
+    interpolationSkipped = false;
 }
 
 Hitbox Entity::getHitBox() const
@@ -37,6 +62,49 @@ Hitbox Entity::getHitBox() const
     return hitbox;
 }
 
+void Entity::setSpatialGrid(SpatialGrid* spatialGrid, const uint32_t index)
+{
+    this->spatialGrid = spatialGrid;
+    spatialGridIndex = index;
+}
+
+bool Entity::isThreadSafe() const
+{
+    return threadSafe;
+}
+
+bool Entity::hasCollisionMask() const
+{
+    return sprite->getCollisionMask() != nullptr;
+}
+
+bool Entity::checkMaskCollision(const Entity* other, Intersection& intersection) const
+{
+    const CollisionMask* mask = sprite->getCollisionMask();
+    const CollisionMask* otherMask = other->sprite->getCollisionMask();
+    const Vector2f size = mask ? scale : hitboxScale;
+    const Vector2f otherSize = otherMask ? other->scale : other->hitboxScale;
+
+    if (!Collision::checkMaskCollision(mask, position - size / 2, size, otherMask, other->position - otherSize / 2, otherSize)) return false;
+
+    // The masks are only tested while unrotated, so the entities are separated along the axis their rectangles overlap the least.
+    const Vector2f offset = position - other->position;
+    const float overlapX = (size.x + otherSize.x) / 2 - std::abs(offset.x);
+    const float overlapY = (size.y + otherSize.y) / 2 - std::abs(offset.y);
+
+    if (overlapX < overlapY)
+    {
+        intersection.penetrationDepth = overlapX;
+        intersection.mtv = {offset.x < 0 ? -overlapX : overlapX, 0};
+    }
+    else
+    {
+        intersection.penetrationDepth = overlapY;
+        intersection.mtv = {0, offset.y < 0 ? -overlapY : overlapY};
+    }
+    return true;
+}
+
 std::vector<Intersection> Entity::getIntersections() const
 {
     return Bee::getCurrentWorld()->getIntersections(this);
@@ -57,19 +125,31 @@ float Entity::getRotation() const
     return rotation;
 }
 
-bool Entity::isCursorOnMe() const
+Vector2f Entity::getPreviousPosition() const
 {
-    Hitbox hitbox;
-    Intersection intersection;
+    return previousPosition;
+}
 
-    hitbox.vertices.push_back(Mouse::getMouseWorldPosition());
+float Entity::getPreviousRotation() const
+{
+    return previousRotation;
+}
 
-    return Collision::checkCollision(getHitBox(), hitbox, intersection);
+void Entity::skipInterpolation()
+{
+    interpolationSkipped = true;
+}
+
+bool Entity::isCursorOnMe() const
+{
+    const std::vector<Entity*>& entities = Bee::getCurrentWorld()->getEntitiesAtPosition(Mouse::getMouseWorldPosition());
+    return std::find(entities.begin(), entities.end(), this) != entities.end();
 }
 
 void Entity::moveOffset(const Vector2f& offset)
 {
     position += offset;
+    if (spatialGrid) spatialGrid->markMoved(spatialGridIndex);
 }
 
 void Entity::setSprite(const std::string& spriteName)
@@ -88,16 +168,19 @@ void Entity::setPosition(const float x, const float y)
 {
     position.x = x;
     position.y = y;
+    if (spatialGrid) spatialGrid->markMoved(spatialGridIndex);
 }
 
 void Entity::setPosition(const Vector2f& position)
 {
     this->position = position;
+    if (spatialGrid) spatialGrid->markMoved(spatialGridIndex);
 }
 
 void Entity::setRotation(const float rotation)
 {
     this->rotation = rotation;
+    if (spatialGrid) spatialGrid->markMoved(spatialGridIndex);
 }
 
 void Entity::setScale(const float scale)
@@ -135,17 +218,30 @@ void Entity::setHitboxScale(const float scale)
     const Vector2i textureSize = sprite->getTextureSize();
     this->hitboxScale.x = static_cast<float>(textureSize.x) / textureSize.y * scale;
     this->hitboxScale.y = scale;
+    if (spatialGrid) spatialGrid->markMoved(spatialGridIndex);
 }
 
 void Entity::setHitboxScale(const float width, const float height)
 {
     hitboxScale.x = width;
     hitboxScale.y = height;
+    if (spatialGrid) spatialGrid->markMoved(spatialGridIndex);
 }
 
 void Entity::setHitboxScale(const Vector2f& scale)
 {
     hitboxScale = scale;
+    if (spatialGrid) spatialGrid->markMoved(spatialGridIndex);
+}
+
+void Entity::setPixelPerfectCollision(const bool enabled)
+{
+    sprite->setCollisionMaskEnabled(enabled);
+}
+
+void Entity::setThreadSafe(const bool threadSafe)
+{
+    this->threadSafe = threadSafe;
 }
 
 void Entity::setAnimation(const std::string& animationName) const
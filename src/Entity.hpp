@@ -13,13 +13,21 @@
 #include "Graphics/Sprite.hpp"
 #include "Math/Vector2f.hpp"
 
+class SpatialGrid;
+
 class Entity
 {
 public:
     //Internal functions start here
 
-    void updateInternal() const;
+    void updateInternal(float interpolationAlpha) const;
+    void updateAnimation() const;
+    void savePreviousTransform();
     Hitbox getHitBox() const;
+    bool hasCollisionMask() const;
+    bool checkMaskCollision(const Entity* other, Intersection& intersection) const;
+    void setSpatialGrid(SpatialGrid* spatialGrid, uint32_t index);
+    bool isThreadSafe() const;
 
     //Internal functions end here
 
@@ -63,6 +71,20 @@ public:
      */
     float getRotation() const;
 
+    /**
+     * @brief Get the position of the entity at the start of the current update. Thread safe entities have to use this instead of getPosition when reading other entities.
+     * 
+     * @return the position of this entity at the start of the update in world coordinates.
+     */
+    Vector2f getPreviousPosition() const;
+
+    /**
+     * @brief Get the rotation of the entity at the start of the current update. Thread safe entities have to use this instead of getRotation when reading other entities.
+     * 
+     * @return the rotation of the entity at the start of the update in degrees.
+     */
+    float getPreviousRotation() const;
+
     /**
      * @brief Move the entity by a given offset.
      * 
@@ -99,7 +121,7 @@ public:
     void setName(const std::string& name);
 
     /**
-     * @brief Set the position of the entity.
+     * @brief Set the position of the entity. With a fixed tick rate, the entity is drawn moving there until the next tick, call skipInterpolation to teleport it.
      * 
      * @param x the x position of the entity in world coordinates
      * @param y the y position of the entity in world coordinates
@@ -107,7 +129,7 @@ public:
     void setPosition(float x, float y);
 
     /**
-     * @brief Set the position of the entity.
+     * @brief Set the position of the entity. With a fixed tick rate, the entity is drawn moving there until the next tick, call skipInterpolation to teleport it.
      * 
      * @param position the position of the entity in world coordinates
      */
@@ -120,6 +142,13 @@ public:
      */
     void setRotation(float rotation);
 
+    /**
+     * @brief Draw the entity at its current position and rotation until the next tick, instead of interpolating from where it was at the start of the tick. Use it after teleporting the entity in fixed timestep mode.
+     * Entities added to the world are not interpolated until their first tick either, so spawning and placing an entity doesn't need this.
+     * 
+     */
+    void skipInterpolation();
+
     /**
      * @brief Set the size of the entity.
      * 
@@ -183,6 +212,24 @@ public:
      */
     void setHitboxScale(const Vector2f& scale);
 
+    /**
+     * @brief Use the alpha channel of the sprite for collisions instead of the rectangular hitbox. Only used while the entity is not rotated.
+     * 
+     * @param enabled true to enable pixel perfect collisions, false otherwise
+     */
+    void setPixelPerfectCollision(bool enabled);
+
+    /**
+     * @brief Update the entity in parallel with other thread safe entities, before the remaining entities are updated. Disabled by default.
+     * 
+     * Its update function may only change the entity itself. Other entities may only be read through getName, getPreviousPosition, getPreviousRotation and their properties,
+     * and the world only through getEntitiesInRadius, getEntitiesInRectangle, getNearestEntities and the getEntitiesAtPosition overload taking a result vector.
+     * The spatial queries see the entities where they were at the start of the update. Everything else, including getIntersections, is not safe to call.
+     * 
+     * @param threadSafe true to update the entity in parallel, false otherwise
+     */
+    void setThreadSafe(bool threadSafe);
+
     /**
      * @brief The update function can be implemented in inhereting classes. This function is called once every frame.
      * 
@@ -199,7 +246,13 @@ private:
     float rotation = 0;
     Sprite* sprite = nullptr;
     Vector2f position;
+    Vector2f previousPosition;
+    float previousRotation = 0;
+    bool interpolationSkipped = false;
     Vector2f rotationCenter = {0.5f, 0.5f};
     Vector2f scale = {1.0f, 1.0f};
     Vector2f hitboxScale = {1.0f, 1.0f};
+    bool threadSafe = false;
+    SpatialGrid* spatialGrid = nullptr;
+    uint32_t spatialGridIndex = 0;
 };
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "GlyphCache.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Log.hpp"
+#include "Renderer.hpp"
+#include "Graphics/TextureAtlas.hpp"
+
+struct Glyph
+{
+    SDL_Texture* texture;
+    SDL_Rect srcRect;
+    int advance;
+};
+
+struct FontGlyphs
+{
+    int pageSize;
+    std::unordered_map<uint32_t, Glyph> glyphs;
+    std::vector<TextureAtlas> pages;
+};
+
+struct LayoutKey
+{
+    TTF_Font* font;
+    std::string text;
+
+    bool operator==(const LayoutKey& other) const = default;
+};
+
+struct LayoutKeyHash
+{
+    size_t operator()(const LayoutKey& key) const
+    {
+        return std::hash<std::string>()(key.text) ^ std::hash<TTF_Font*>()(key.font) * 31;
+    }
+};
+
+struct CachedLayout
+{
+    LayoutKey key;
+    std::shared_ptr<const TextLayout> layout;
+    size_t bytes;
+};
+
+static std::unordered_map<TTF_Font*, FontGlyphs> fontGlyphsMap;
+// Most recently used layouts are at the front.
+static std::list<CachedLayout> layoutList;
+static std::unordered_map<LayoutKey, std::list<CachedLayout>::iterator, LayoutKeyHash> layoutMap;
+static size_t layoutCacheBytes = 0;
+static size_t layoutCacheBudget = 1024 * 1024;
+
+static uint32_t decodeUTF8(const std::string& text, size_t& index)
+{
+    const auto byte = static_cast<uint8_t>(text[index++]);
+
+    int length = 0;
+    uint32_t codepoint = byte;
+
+    if (byte >= 0xF0)
+    {
+        length = 3;
+        codepoint = byte & 0x07;
+    }
+    else if (byte >= 0xE0)
+    {
+        length = 2;
+        codepoint = byte & 0x0F;
+    }
+    else if (byte >= 0xC0)
+    {
+        length = 1;
+        codepoint = byte & 0x1F;
+    }
+
+    for (; length > 0 && index < text.size(); length--)
+    {
+        codepoint = codepoint << 6 | (static_cast<uint8_t>(text[index++]) & 0x3F);
+    }
+    return codepoint;
+}
+
+static const Glyph& loadGlyph(TTF_Font* font, FontGlyphs& fontGlyphs, const uint32_t codepoint)
+{
+    if (const auto iterator = fontGlyphs.glyphs.find(codepoint); iterator != fontGlyphs.glyphs.end())
+        return iterator->second;
+
+    Glyph glyph = {nullptr, {0, 0, 0, 0}, 0};
+    TTF_GlyphMetrics32(font, codepoint, nullptr, nullptr, nullptr, nullptr, &glyph.advance);
+
+    // Glyphs are rendered white and tinted with the vertex color of the text.
+    SDL_Surface* renderedSurface = TTF_RenderGlyph32_Blended(font, codepoint, {255, 255, 255, 255});
+    SDL_Surface* surface = renderedSurface ? SDL_ConvertSurfaceFormat(renderedSurface, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+    SDL_FreeSurface(renderedSurface);
+
+    if (surface != nullptr && surface->w > 0 && surface->h > 0)
+    {
+        for (TextureAtlas& page : fontGlyphs.pages)
+        {
+            if (page.insert(surface, glyph.srcRect))
+            {
+                glyph.texture = page.getTexture();
+                break;
+            }
+        }
+
+        if (glyph.texture == nullptr)
+        {
+            TextureAtlas& page = fontGlyphs.pages.emplace_back(Renderer::createAtlas(fontGlyphs.pageSize));
+            SDL_SetTextureScaleMode(page.getTexture(), SDL_ScaleModeBest);
+
+            if (page.insert(surface, glyph.srcRect))
+            {
+                glyph.texture = page.getTexture();
+            }
+            else
+            {
+                Log::write("Renderer", LogLevel::warning, "Glyph %u does not fit into a glyph atlas", codepoint);
+            }
+        }
+    }
+    SDL_FreeSurface(surface);
+
+    return fontGlyphs.glyphs.insert({codepoint, glyph}).first->second;
+}
+
+static void evictLayouts(const size_t budget)
+{
+    while (layoutCacheBytes > budget && !layoutList.empty())
+    {
+        layoutCacheBytes -= layoutList.back().bytes;
+        layoutMap.erase(layoutList.back().key);
+        layoutList.pop_back();
+    }
+}
+
+static void buildLayout(TTF_Font* font, const std::string& text, TextLayout& layout)
+{
+    layout.size = Vector2i(0, 0);
+    layout.quads.clear();
+
+    auto [iterator, inserted] = fontGlyphsMap.try_emplace(font);
+    FontGlyphs& fontGlyphs = iterator->second;
+
+    if (inserted)
+    {
+        fontGlyphs.pageSize = 512;
+        while (fontGlyphs.pageSize < TTF_FontHeight(font) * 4)
+        {
+            fontGlyphs.pageSize *= 2;
+        }
+    }
+
+    const int lineSkip = TTF_FontLineSkip(font);
+    int x = 0;
+    int y = 0;
+    uint32_t previous = 0;
+
+    for (size_t i = 0; i < text.size();)
+    {
+        const uint32_t codepoint = decodeUTF8(text, i);
+
+        if (codepoint == '\n')
+        {
+            x = 0;
+            y += lineSkip;
+            previous = 0;
+            continue;
+        }
+
+        if (previous != 0)
+        {
+            x += TTF_GetFontKerningSizeGlyphs32(font, previous, codepoint);
+        }
+        previous = codepoint;
+
+        const Glyph& glyph = loadGlyph(font, fontGlyphs, codepoint);
+
+        if (glyph.texture != nullptr)
+        {
+            layout.quads.push_back({glyph.texture, glyph.srcRect, {x, y, glyph.srcRect.w, glyph.srcRect.h}});
+            layout.size.x = std::max(layout.size.x, x + glyph.srcRect.w);
+        }
+
+        x += glyph.advance;
+        layout.size.x = std::max(layout.size.x, x);
+    }
+
+    if (!text.empty())
+    {
+        layout.size.y = y + TTF_FontHeight(font);
+    }
+}
+
+std::shared_ptr<const TextLayout> GlyphCache::layoutText(TTF_Font* font, const std::string& text)
+{
+    if (font == nullptr) return nullptr;
+
+    // Glyphs are rendered into atlas textures, which only the render thread may touch.
+    if (!Renderer::isRenderThread())
+    {
+        std::shared_ptr<const TextLayout> layout;
+        Renderer::runOnRenderThread([&layout, font, &text] { layout = layoutText(font, text); });
+        return layout;
+    }
+
+    LayoutKey key = {font, text};
+
+    if (const auto iterator = layoutMap.find(key); iterator != layoutMap.end())
+    {
+        layoutList.splice(layoutList.begin(), layoutList, iterator->second);
+        return iterator->second->layout;
+    }
+
+    auto layout = std::make_shared<TextLayout>();
+    buildLayout(font, text, *layout);
+
+    const size_t bytes = sizeof(CachedLayout) + sizeof(TextLayout) + text.size() + layout->quads.size() * sizeof(GlyphQuad);
+
+    // The newest layout is always kept, even if it alone exceeds the budget.
+    evictLayouts(layoutCacheBudget > bytes ? layoutCacheBudget - bytes : 0);
+
+    layoutList.push_front({key, layout, bytes});
+    layoutMap.insert({std::move(key), layoutList.begin()});
+    layoutCacheBytes += bytes;
+
+    return layout;
+}
+
+void GlyphCache::setLayoutCacheBudget(const size_t bytes)
+{
+    layoutCacheBudget = bytes;
+    evictLayouts(layoutCacheBudget);
+}
+
+void GlyphCache::unloadFont(TTF_Font* font)
+{
+    for (auto iterator = layoutList.begin(); iterator != layoutList.end();)
+    {
+        if (iterator->key.font != font)
+        {
+            ++iterator;
+            continue;
+        }
+
+        layoutCacheBytes -= iterator->bytes;
+        layoutMap.erase(iterator->key);
+        iterator = layoutList.erase(iterator);
+    }
+
+    const auto fontGlyphs = fontGlyphsMap.find(font);
+    if (fontGlyphs == fontGlyphsMap.end()) return;
+
+    for (TextureAtlas& page : fontGlyphs->second.pages)
+    {
+        Renderer::destroyTexture(page.getTexture());
+    }
+    fontGlyphsMap.erase(fontGlyphs);
+}
+
+void GlyphCache::unloadAll()
+{
+    evictLayouts(0);
+
+    for (auto& [font, fontGlyphs] : fontGlyphsMap)
+    {
+        for (TextureAtlas& page : fontGlyphs.pages)
+        {
+            Renderer::destroyTexture(page.getTexture());
+        }
+    }
+    fontGlyphsMap.clear();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "Math/Vector2i.hpp"
+
+struct GlyphQuad
+{
+    SDL_Texture* texture;
+    SDL_Rect srcRect;
+    SDL_Rect dstRect;
+};
+
+struct TextLayout
+{
+    Vector2i size;
+    std::vector<GlyphQuad> quads;
+};
+
+namespace GlyphCache
+{
+    std::shared_ptr<const TextLayout> layoutText(TTF_Font* font, const std::string& text);
+    void setLayoutCacheBudget(size_t bytes);
+    void unloadFont(TTF_Font* font);
+    void unloadAll();
+};
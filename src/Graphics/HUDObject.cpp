@@ -1,8 +1,11 @@
 #include "Graphics/HUDObject.hpp"
 
-#include "Collision/Collision.hpp"
+#include <cmath>
+
+#include "Bee.hpp"
 #include "Graphics/Sprite.hpp"
-#include "Input/Mouse.hpp"
+
+static uint64_t transformVersion = 0;
 
 HUDObject::HUDObject()
 {
@@ -16,6 +19,11 @@ void HUDObject::updateInternal() const
     sprite->updateInternalHUD(position, scale, rotationCenter, rotation);
 }
 
+void HUDObject::updateAnimation() const
+{
+    sprite->updateAnimation();
+}
+
 void HUDObject::setAnimation(const std::string& animationName) const
 {
     sprite->setAnimation(animationName);
@@ -37,50 +45,84 @@ Vector2i HUDObject::getTextureSize() const
     return sprite->getTextureSize();
 }
 
-bool HUDObject::isCursorOnMe() const
+void HUDObject::getBounds(Vector2i& min, Vector2i& max) const
 {
-    Hitbox hitbox;
-    Hitbox cursor;
-    Intersection intersection;
-    const Vector2i center = position + scale / 2;
-    const Vector2i cursorPosition = Mouse::getMouseScreenPosition();
+    if (rotation == 0)
+    {
+        min = position;
+        max = position + scale;
+        return;
+    }
+
+    const float cosine = fabsf(cosf(rotation * M_PI / 180.0f));
+    const float sine = fabsf(sinf(rotation * M_PI / 180.0f));
+    const float halfWidth = scale.x / 2.0f * cosine + scale.y / 2.0f * sine;
+    const float halfHeight = scale.x / 2.0f * sine + scale.y / 2.0f * cosine;
+    const float centerX = position.x + scale.x / 2.0f;
+    const float centerY = position.y + scale.y / 2.0f;
+
+    min.x = static_cast<int>(floorf(centerX - halfWidth));
+    min.y = static_cast<int>(floorf(centerY - halfHeight));
+    max.x = static_cast<int>(ceilf(centerX + halfWidth));
+    max.y = static_cast<int>(ceilf(centerY + halfHeight));
+}
 
-    hitbox.vertices.emplace_back(center.x - scale.x / 2.0f * cosf(rotation * M_PI / 180.0f) - scale.y / 2.0f * sinf(rotation * M_PI / 180.0f), center.y - scale.x / 2.0f * sinf(rotation * M_PI / 180.0f) + scale.y / 2.0f * cosf(rotation * M_PI / 180.0f));
-    hitbox.vertices.emplace_back(center.x + scale.x / 2.0f * cosf(rotation * M_PI / 180.0f) - scale.y / 2.0f * sinf(rotation * M_PI / 180.0f), center.y + scale.x / 2.0f * sinf(rotation * M_PI / 180.0f) + scale.y / 2.0f * cosf(rotation * M_PI / 180.0f));
-    hitbox.vertices.emplace_back(center.x - scale.x / 2.0f * cosf(rotation * M_PI / 180.0f) + scale.y / 2.0f * sinf(rotation * M_PI / 180.0f), center.y - scale.x / 2.0f * sinf(rotation * M_PI / 180.0f) - scale.y / 2.0f * cosf(rotation * M_PI / 180.0f));
-    hitbox.vertices.emplace_back(center.x + scale.x / 2.0f * cosf(rotation * M_PI / 180.0f) + scale.y / 2.0f * sinf(rotation * M_PI / 180.0f), center.y + scale.x / 2.0f * sinf(rotation * M_PI / 180.0f) - scale.y / 2.0f * cosf(rotation * M_PI / 180.0f));
+bool HUDObject::containsPoint(const Vector2i& point) const
+{
+    if (rotation == 0)
+    {
+        return point.x >= position.x && point.x <= position.x + scale.x && point.y >= position.y && point.y <= position.y + scale.y;
+    }
 
-    cursor.vertices.emplace_back(cursorPosition.x, cursorPosition.y);
+    const float cosine = cosf(rotation * M_PI / 180.0f);
+    const float sine = sinf(rotation * M_PI / 180.0f);
+    const float x = point.x - (position.x + scale.x / 2.0f);
+    const float y = point.y - (position.y + scale.y / 2.0f);
 
-    return Collision::checkCollision(hitbox, cursor, intersection);
+    return fabsf(x * cosine + y * sine) <= scale.x / 2.0f && fabsf(y * cosine - x * sine) <= scale.y / 2.0f;
+}
+
+uint64_t HUDObject::getTransformVersion()
+{
+    return transformVersion;
+}
+
+bool HUDObject::isCursorOnMe() const
+{
+    return Bee::getCurrentWorld()->getHUDObjectUnderCursor() == this;
 }
 
 void HUDObject::setPosition(const int x, const int y)
 {
     position.x = x;
     position.y = y;
+    transformVersion++;
 }
 
 void HUDObject::setPosition(const Vector2i& position)
 {
     this->position = position;
+    transformVersion++;
 }
 
 void HUDObject::setSize(const float scale)
 {
     const Vector2i textureSize = sprite->getTextureSize();
     this->scale = textureSize * scale;
+    transformVersion++;
 }
 
 void HUDObject::setSize(const int width, const int height)
 {
     scale.x = width;
     scale.y = height;
+    transformVersion++;
 }
 
 void HUDObject::setSize(const Vector2i& scale)
 {
     this->scale = scale;
+    transformVersion++;
 }
 
 void HUDObject::setFont(const std::string& fontName, const int size) const
@@ -17,6 +17,10 @@ public:
     /*Internal functions start here*/
 
     void updateInternal() const;
+    void updateAnimation() const;
+    void getBounds(Vector2i& min, Vector2i& max) const;
+    bool containsPoint(const Vector2i& point) const;
+    static uint64_t getTransformVersion();
 
     /*Internal functions end here*/
 
@@ -56,9 +60,9 @@ public:
     Vector2i getTextureSize() const;
 
     /**
-     * @brief Check if the cursor is on the HUD object.
+     * @brief Check if the cursor is on the HUD object. Only the topmost HUD object under the cursor counts.
      * 
-     * @return true if the cursor is on the HUD object, false otherwise.
+     * @return true if the cursor is on the HUD object and no other HUD object is drawn on top of it, false otherwise.
      */
     bool isCursorOnMe() const;
 
@@ -0,0 +1,252 @@
+#include "ImageCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <SDL2/SDL_image.h>
+
+#include "Assets.hpp"
+#include "Assets/Compression.hpp"
+#include "Assets/Hash.hpp"
+
+// Cached images are RGBA32 pixels in native byte order, LZ4 compressed when that makes them smaller.
+// Files are named after a hash of the source image, so an edited image simply misses the cache.
+struct CachedImageHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    int32_t width;
+    int32_t height;
+    uint32_t dataSize;
+    uint32_t compressed;
+};
+
+struct CacheFile
+{
+    std::filesystem::path path;
+    uintmax_t size;
+    std::filesystem::file_time_type lastUsed;
+};
+
+static constexpr char cachedImageMagic[4] = {'B', 'T', 'E', 'X'};
+static constexpr uint32_t cachedImageVersion = 1;
+static constexpr int32_t maxCachedImageSize = 16384;
+static const std::filesystem::path cacheDirectory = "./cache/Textures";
+
+static std::atomic<bool> cacheEnabled = true;
+static std::atomic<size_t> budget = 256 * 1024 * 1024;
+static std::atomic<unsigned int> temporaryFileCount = 0;
+static std::mutex cacheMutex;
+// Size of the cache directory, scanned when the first image is written.
+static size_t cacheBytes = 0;
+static bool cacheScanned = false;
+
+static std::filesystem::path getCachePath(const uint64_t sourceHash)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.tex", static_cast<unsigned long long>(sourceHash));
+    return cacheDirectory / name;
+}
+
+static std::vector<CacheFile> listCacheFiles()
+{
+    std::vector<CacheFile> files;
+    std::error_code error;
+
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(cacheDirectory, error))
+    {
+        // Files that are still being written have a temporary extension.
+        if (!entry.is_regular_file(error) || entry.path().extension() != ".tex") continue;
+
+        const uintmax_t size = entry.file_size(error);
+        if (error) continue;
+        const std::filesystem::file_time_type lastUsed = entry.last_write_time(error);
+        if (error) continue;
+
+        files.push_back({entry.path(), size, lastUsed});
+    }
+    return files;
+}
+
+// Removes the least recently used images until the cache fits its budget, must be called with the cache mutex locked.
+static void trimCache()
+{
+    std::vector<CacheFile> files = listCacheFiles();
+    std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) {
+        return a.lastUsed < b.lastUsed;
+    });
+
+    cacheBytes = 0;
+    for (const CacheFile& file : files)
+    {
+        cacheBytes += file.size;
+    }
+    cacheScanned = true;
+
+    std::error_code error;
+    for (const CacheFile& file : files)
+    {
+        if (cacheBytes <= budget) break;
+
+        if (std::filesystem::remove(file.path, error))
+        {
+            cacheBytes -= file.size;
+        }
+    }
+}
+
+static void addCacheFile(const size_t bytes)
+{
+    std::lock_guard lock(cacheMutex);
+
+    if (cacheScanned)
+    {
+        cacheBytes += bytes;
+        if (cacheBytes <= budget) return;
+    }
+
+    trimCache();
+}
+
+static SDL_Surface* decodeImage(SDL_RWops* file)
+{
+    SDL_Surface* loadedSurface = IMG_Load_RW(file, 1);
+    if (loadedSurface == nullptr) return nullptr;
+
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loadedSurface);
+    return surface;
+}
+
+static SDL_Surface* readCachedImage(const std::filesystem::path& path, const uint64_t sourceHash)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return nullptr;
+
+    CachedImageHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return nullptr;
+    if (memcmp(header.magic, cachedImageMagic, sizeof(header.magic)) != 0 || header.version != cachedImageVersion || header.sourceHash != sourceHash) return nullptr;
+    if (header.width <= 0 || header.height <= 0 || header.width > maxCachedImageSize || header.height > maxCachedImageSize) return nullptr;
+
+    // Only images that got smaller are stored compressed.
+    const size_t pixelSize = static_cast<size_t>(header.width) * header.height * 4;
+    if (header.compressed ? header.dataSize >= pixelSize : header.dataSize != pixelSize) return nullptr;
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, header.width, header.height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (surface == nullptr) return nullptr;
+
+    bool valid = surface->pitch == header.width * 4;
+    if (valid && header.compressed)
+    {
+        std::vector<uint8_t> data(header.dataSize);
+        valid = file.read(reinterpret_cast<char*>(data.data()), data.size())
+            && Compression::decompress(data.data(), data.size(), static_cast<uint8_t*>(surface->pixels), pixelSize);
+    }
+    else if (valid)
+    {
+        valid = static_cast<bool>(file.read(static_cast<char*>(surface->pixels), pixelSize));
+    }
+
+    if (!valid)
+    {
+        SDL_FreeSurface(surface);
+        return nullptr;
+    }
+
+    // The modification time orders the cache for trimming, so a hit marks the image as recently used.
+    std::error_code error;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    return surface;
+}
+
+static void writeCachedImage(const std::filesystem::path& path, const uint64_t sourceHash, const SDL_Surface* surface)
+{
+    const size_t pixelSize = static_cast<size_t>(surface->w) * surface->h * 4;
+    if (surface->pitch != surface->w * 4 || surface->w > maxCachedImageSize || surface->h > maxCachedImageSize) return;
+    if (pixelSize + sizeof(CachedImageHeader) > budget) return;
+
+    const uint8_t* pixels = static_cast<const uint8_t*>(surface->pixels);
+    const std::vector<uint8_t> compressedPixels = Compression::compress(pixels, pixelSize);
+    const bool compressed = compressedPixels.size() < pixelSize;
+
+    CachedImageHeader header;
+    memcpy(header.magic, cachedImageMagic, sizeof(header.magic));
+    header.version = cachedImageVersion;
+    header.sourceHash = sourceHash;
+    header.width = surface->w;
+    header.height = surface->h;
+    header.dataSize = static_cast<uint32_t>(compressed ? compressedPixels.size() : pixelSize);
+    header.compressed = compressed;
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+
+    // Written under a temporary name first, so another thread never reads a half written image.
+    std::filesystem::path temporaryPath = path;
+    temporaryPath += ".tmp" + std::to_string(temporaryFileCount++);
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(compressed ? compressedPixels.data() : pixels), header.dataSize);
+        if (!file)
+        {
+            file.close();
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+    }
+
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        std::filesystem::remove(temporaryPath, error);
+        return;
+    }
+    addCacheFile(sizeof(header) + header.dataSize);
+}
+
+SDL_Surface* ImageCache::load(const std::string& path)
+{
+    // Embedded assets are meant to load without any file access.
+    if (!cacheEnabled || Assets::isEmbedded()) return decodeImage(Assets::open(path));
+
+    std::string source;
+    if (!Assets::readFile(path, source)) return nullptr;
+
+    const uint64_t sourceHash = hashData(source.data(), source.size());
+    const std::filesystem::path cachePath = getCachePath(sourceHash);
+
+    if (SDL_Surface* surface = readCachedImage(cachePath, sourceHash)) return surface;
+
+    SDL_Surface* surface = decodeImage(SDL_RWFromConstMem(source.data(), static_cast<int>(source.size())));
+    if (surface != nullptr)
+    {
+        writeCachedImage(cachePath, sourceHash, surface);
+    }
+    return surface;
+}
+
+void ImageCache::setEnabled(const bool enabled)
+{
+    cacheEnabled = enabled;
+}
+
+void ImageCache::setBudget(const size_t bytes)
+{
+    budget = bytes;
+
+    std::lock_guard lock(cacheMutex);
+    if (!cacheScanned || cacheBytes > budget)
+    {
+        trimCache();
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <SDL2/SDL.h>
+
+// Decoded images are cached on disk so they don't have to be inflated again on the next start.
+// Safe to call from the image decoder threads, nothing here logs.
+namespace ImageCache
+{
+    SDL_Surface* load(const std::string& path);
+    void setEnabled(bool enabled);
+    void setBudget(size_t bytes);
+};
@@ -0,0 +1,78 @@
+#include "ImageDecoder.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "ImageCache.hpp"
+#include "Jobs.hpp"
+
+static std::mutex decodedMutex;
+static std::condition_variable decodedCondition;
+static std::deque<DecodedImage> decodedImages;
+// Decodes that have started, shutting down waits for them. Jobs that haven't started yet see stopping and skip.
+static int runningDecodes = 0;
+static bool stopping = false;
+
+static void decodeImage(std::string name, const std::string& path)
+{
+    {
+        std::lock_guard lock(decodedMutex);
+        if (stopping) return;
+        runningDecodes++;
+    }
+
+    // The surface is converted here, so the main thread only has to upload it.
+    SDL_Surface* surface = ImageCache::load(path);
+
+    // Errors are logged by the main thread, the log isn't thread safe.
+    std::string error = surface ? "" : SDL_GetError();
+
+    std::lock_guard lock(decodedMutex);
+    runningDecodes--;
+    if (stopping)
+    {
+        SDL_FreeSurface(surface);
+    }
+    else
+    {
+        decodedImages.push_back({std::move(name), surface, std::move(error)});
+    }
+    decodedCondition.notify_all();
+}
+
+void ImageDecoder::request(const std::string& name, const std::string& path)
+{
+    {
+        std::lock_guard lock(decodedMutex);
+        stopping = false;
+    }
+
+    // Decoding shares the engine's worker threads with every other job.
+    Jobs::run([name, path] { decodeImage(name, path); });
+}
+
+bool ImageDecoder::popDecoded(DecodedImage& image)
+{
+    std::lock_guard lock(decodedMutex);
+    if (decodedImages.empty()) return false;
+
+    image = std::move(decodedImages.front());
+    decodedImages.pop_front();
+    return true;
+}
+
+void ImageDecoder::shutdown()
+{
+    std::unique_lock lock(decodedMutex);
+    stopping = true;
+    decodedCondition.wait(lock, [] { return runningDecodes == 0; });
+
+    for (const DecodedImage& image : decodedImages)
+    {
+        SDL_FreeSurface(image.surface);
+    }
+    decodedImages.clear();
+}
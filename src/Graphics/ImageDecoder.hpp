@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+#include <SDL2/SDL.h>
+
+struct DecodedImage
+{
+    std::string name;
+    SDL_Surface* surface;
+    std::string error;
+};
+
+namespace ImageDecoder
+{
+    void request(const std::string& name, const std::string& path);
+    bool popDecoded(DecodedImage& image);
+    void shutdown();
+};
@@ -1,32 +1,317 @@
 #include "Renderer.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <filesystem>
-#include <map>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "Assets.hpp"
 #include "Log.hpp"
+#include "ResourceCache.hpp"
+#include "Graphics/GlyphCache.hpp"
+#include "Graphics/ImageCache.hpp"
+#include "Graphics/ImageDecoder.hpp"
+#include "Graphics/SpriteSheet.hpp"
+#include "Graphics/TextureAtlas.hpp"
+#include "Math/BatchTransform.hpp"
 #include "Math/Vector2f.hpp"
 #include "Math/Vector2i.hpp"
 
+struct RenderCommand
+{
+    SDL_Texture* texture;
+    SDL_Rect srcRect;
+    SDL_FRect dstRect;
+    SDL_FPoint center;
+    float rotation;
+    SDL_Color color;
+    uint16_t layer;
+    bool sortByTexture;
+    bool hasSrcRect;
+    // The rect is in world units and the center is relative to its size until the queue is flushed.
+    bool worldSpace;
+};
+
 static SDL_Window* window = nullptr;
 static SDL_Renderer* renderer = nullptr;
 static SDL_Texture* targetTexture = nullptr;
-static std::map<std::pair<std::string, int>, TTF_Font*> fontMap;
-static std::unordered_map<std::string, SDL_Texture*> textureMap;
+// Without a window, textures live in a software renderer that never draws anything.
+static SDL_Surface* headlessSurface = nullptr;
+static bool headlessMode = false;
+struct PendingTexture
+{
+    int references = 0;
+    std::vector<std::function<void(const TextureRegion&)>> callbacks;
+};
+
+struct FontKeyHash
+{
+    size_t operator()(const std::pair<std::string, int>& key) const
+    {
+        return std::hash<std::string>()(key.first) ^ std::hash<int>()(key.second) * 31;
+    }
+};
+
+static void unloadFont(const std::pair<std::string, int>& key, TTF_Font* font);
+static void unloadTexture(const std::string& textureName, TextureRegion region);
+static void uploadDecodedTextures(float budget);
+
+static ResourceCache<std::pair<std::string, int>, TTF_Font*, FontKeyHash> fontCache(unloadFont);
+static ResourceCache<std::string, TextureRegion> textureCache(unloadTexture);
+static std::vector<TextureAtlas> atlases;
+static std::unordered_map<std::string, PendingTexture> pendingTextures;
+static SDL_Texture* placeholderTexture = nullptr;
+static float textureUploadBudget = 2.0f;
+static bool asyncTextureLoading = true;
+// Renderer state belongs to the thread that created the renderer. The simulation thread hands its calls over.
+static std::thread::id renderThread;
+static std::mutex renderTaskMutex;
+static std::condition_variable renderTaskCondition;
+static const std::function<void()>* renderTask = nullptr;
+static bool simulationRunning = false;
+// Number of loaded textures packed into each atlas, an atlas is destroyed when it drops to zero.
+static std::unordered_map<SDL_Texture*, int> atlasRegionCounts;
+// Part of the texture cache size that lives in atlases, where the whole atlas takes up memory instead.
+static size_t packedTextureBytes = 0;
+static int atlasSize = 2048;
 static Vector2f cameraPosition;
 static Vector2f viewportSize(16.0f, 9.0f);
 static Vector2i screenSize;
 static Vector2i windowSize;
+static std::vector<RenderCommand> renderQueue;
+static std::vector<SDL_Texture*> destroyQueue;
+static std::vector<SDL_Vertex> batchVertices;
+static std::vector<int> batchIndices;
+static uint16_t currentLayer = 0;
+static bool currentLayerSortByTexture = false;
+static bool spriteTextureSorting = false;
+static bool geometryBatching = true;
+static int drawCalls = 0;
+// Camera transform of the frame being queued, tiles and sprites are transformed with it in bulk when the queue is flushed.
+static Vector2f queuedWorldOffset;
+static Vector2f queuedWorldScale;
+static Vector2f queuedTileSize(1, 1);
+static std::vector<float> worldX;
+static std::vector<float> worldY;
+static std::vector<float> worldWidth;
+static std::vector<float> worldHeight;
+static int textureSwitches = 0;
+static int unsortedTextureSwitches = 0;
+
+static int countTextureSwitches()
+{
+    int switches = 0;
+    const SDL_Texture* lastTexture = nullptr;
+
+    for (const RenderCommand& command : renderQueue)
+    {
+        if (command.texture != lastTexture) switches++;
+        lastTexture = command.texture;
+    }
+    return switches;
+}
+
+static void pushCommand(SDL_Texture* texture, const SDL_Rect* srcRect, const SDL_FRect& dstRect, const SDL_FPoint& center, const float rotation, const SDL_Color& color = {255, 255, 255, 255}, const bool worldSpace = false)
+{
+    RenderCommand command;
+    command.texture = texture;
+    command.srcRect = srcRect ? *srcRect : SDL_Rect{};
+    command.dstRect = dstRect;
+    command.center = center;
+    command.rotation = rotation;
+    command.color = color;
+    command.layer = currentLayer;
+    command.sortByTexture = currentLayerSortByTexture;
+    command.hasSrcRect = srcRect != nullptr;
+    command.worldSpace = worldSpace;
+    renderQueue.push_back(command);
+}
+
+// Converts the rects of all queued tiles and sprites from world units to pixels in one pass.
+static void transformWorldCommands()
+{
+    worldX.clear();
+    worldY.clear();
+    worldWidth.clear();
+    worldHeight.clear();
+
+    for (const RenderCommand& command : renderQueue)
+    {
+        if (!command.worldSpace) continue;
+
+        worldX.push_back(command.dstRect.x);
+        worldY.push_back(command.dstRect.y);
+        worldWidth.push_back(command.dstRect.w);
+        worldHeight.push_back(command.dstRect.h);
+    }
+
+    if (worldX.empty()) return;
+
+    BatchTransform::transform(worldX.data(), worldY.data(), worldX.data(), worldY.data(), worldX.size(), queuedWorldOffset, queuedWorldScale);
+    BatchTransform::transform(worldWidth.data(), worldHeight.data(), worldWidth.data(), worldHeight.data(), worldWidth.size(), Vector2f(0, 0), queuedWorldScale);
+
+    size_t i = 0;
+    for (RenderCommand& command : renderQueue)
+    {
+        if (!command.worldSpace) continue;
+
+        command.dstRect = {worldX[i], worldY[i], worldWidth[i], worldHeight[i]};
+        command.center.x *= command.dstRect.w;
+        command.center.y *= command.dstRect.h;
+        command.worldSpace = false;
+        i++;
+    }
+}
+
+static void appendQuad(const RenderCommand& command, const Vector2i& textureSize)
+{
+    const SDL_FRect& dstRect = command.dstRect;
+    float x[4] = {dstRect.x, dstRect.x + dstRect.w, dstRect.x + dstRect.w, dstRect.x};
+    float y[4] = {dstRect.y, dstRect.y, dstRect.y + dstRect.h, dstRect.y + dstRect.h};
+
+    if (command.rotation != 0)
+    {
+        BatchTransform::rotate(x, y, x, y, 4, Vector2f(dstRect.x + command.center.x, dstRect.y + command.center.y), command.rotation);
+    }
+
+    float u0 = 0;
+    float v0 = 0;
+    float u1 = 1;
+    float v1 = 1;
+
+    if (command.hasSrcRect && textureSize.x > 0 && textureSize.y > 0)
+    {
+        u0 = static_cast<float>(command.srcRect.x) / textureSize.x;
+        v0 = static_cast<float>(command.srcRect.y) / textureSize.y;
+        u1 = static_cast<float>(command.srcRect.x + command.srcRect.w) / textureSize.x;
+        v1 = static_cast<float>(command.srcRect.y + command.srcRect.h) / textureSize.y;
+    }
+
+    const float u[4] = {u0, u1, u1, u0};
+    const float v[4] = {v0, v0, v1, v1};
+    const int first = static_cast<int>(batchVertices.size());
+
+    for (int i = 0; i < 4; i++)
+    {
+        batchVertices.push_back({{x[i], y[i]}, command.color, {u[i], v[i]}});
+    }
+
+    batchIndices.push_back(first);
+    batchIndices.push_back(first + 1);
+    batchIndices.push_back(first + 2);
+    batchIndices.push_back(first + 2);
+    batchIndices.push_back(first + 3);
+    batchIndices.push_back(first);
+}
+
+template <typename Function>
+static auto onRenderThread(Function function)
+{
+    if constexpr (std::is_void_v<decltype(function())>)
+    {
+        Renderer::runOnRenderThread(function);
+    }
+    else
+    {
+        decltype(function()) result{};
+        Renderer::runOnRenderThread([&result, &function] { result = function(); });
+        return result;
+    }
+}
+
+static void clearQueue()
+{
+    renderQueue.clear();
+    currentLayer = 0;
+    currentLayerSortByTexture = false;
+
+    for (SDL_Texture* texture : destroyQueue)
+    {
+        SDL_DestroyTexture(texture);
+    }
+    destroyQueue.clear();
+}
+
+static void flush()
+{
+    transformWorldCommands();
+    unsortedTextureSwitches = countTextureSwitches();
+
+    // Layers keep their order. Inside layers that allow it, draws are grouped by texture.
+    std::stable_sort(renderQueue.begin(), renderQueue.end(), [](const RenderCommand& left, const RenderCommand& right)
+    {
+        if (left.layer != right.layer) return left.layer < right.layer;
+        return left.sortByTexture && std::less<SDL_Texture*>()(left.texture, right.texture);
+    });
+
+    textureSwitches = countTextureSwitches();
+
+    drawCalls = 0;
+
+    if (geometryBatching)
+    {
+        size_t i = 0;
+        while (i < renderQueue.size())
+        {
+            SDL_Texture* texture = renderQueue[i].texture;
+            Vector2i textureSize;
+            SDL_QueryTexture(texture, nullptr, nullptr, &textureSize.x, &textureSize.y);
+
+            batchVertices.clear();
+            batchIndices.clear();
 
-void Renderer::init(const int windowWidth, const int windowHeight)
+            for (; i < renderQueue.size() && renderQueue[i].texture == texture; i++)
+            {
+                appendQuad(renderQueue[i], textureSize);
+            }
+
+            if (texture == nullptr) continue;
+
+            SDL_RenderGeometry(renderer, texture, batchVertices.data(), static_cast<int>(batchVertices.size()), batchIndices.data(), static_cast<int>(batchIndices.size()));
+            drawCalls++;
+        }
+    }
+    else
+    {
+        for (const RenderCommand& command : renderQueue)
+        {
+            const SDL_Rect* srcRect = command.hasSrcRect ? &command.srcRect : nullptr;
+            SDL_SetTextureColorMod(command.texture, command.color.r, command.color.g, command.color.b);
+            SDL_SetTextureAlphaMod(command.texture, command.color.a);
+
+            if (command.rotation == 0)
+            {
+                SDL_RenderCopyF(renderer, command.texture, srcRect, &command.dstRect);
+            }
+            else
+            {
+                SDL_RenderCopyExF(renderer, command.texture, srcRect, &command.dstRect, command.rotation, &command.center, SDL_FLIP_NONE);
+            }
+            drawCalls++;
+        }
+    }
+
+    clearQueue();
+}
+
+void Renderer::init(const int windowWidth, const int windowHeight, const bool headless)
 {
-    if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0)
+    renderThread = std::this_thread::get_id();
+    headlessMode = headless;
+
+    if (!headless && SDL_InitSubSystem(SDL_INIT_VIDEO) < 0)
     {
         Log::write("Renderer", LogLevel::error, "Error initializing video system: %s", SDL_GetError());
         exit(EXIT_FAILURE);
@@ -44,27 +329,64 @@ void Renderer::init(const int windowWidth, const int windowHeight)
         exit(EXIT_FAILURE);
     }
 
-    window = SDL_CreateWindow("Bee Engine", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, 0);
-    if (window == nullptr)
+    if (headless)
     {
-        Log::write("Renderer", LogLevel::error, "Error creating Window: %s", SDL_GetError());
-        exit(EXIT_FAILURE);
+        headlessSurface = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_RGBA32);
+        renderer = headlessSurface ? SDL_CreateSoftwareRenderer(headlessSurface) : nullptr;
+        if (renderer == nullptr)
+        {
+            Log::write("Renderer", LogLevel::error, "Error creating headless renderer: %s", SDL_GetError());
+            exit(EXIT_FAILURE);
+        }
     }
-
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_TARGETTEXTURE | SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (renderer == nullptr)
+    else
     {
-        Log::write("Renderer", LogLevel::error, "Error creating renderer: %s", SDL_GetError());
-        exit(EXIT_FAILURE);
+        window = SDL_CreateWindow("Bee Engine", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, 0);
+        if (window == nullptr)
+        {
+            Log::write("Renderer", LogLevel::error, "Error creating Window: %s", SDL_GetError());
+            exit(EXIT_FAILURE);
+        }
+
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_TARGETTEXTURE | SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        if (renderer == nullptr)
+        {
+            Log::write("Renderer", LogLevel::error, "Error creating renderer: %s", SDL_GetError());
+            exit(EXIT_FAILURE);
+        }
+
+        SDL_SetWindowResizable(window, SDL_TRUE);
     }
 
-    SDL_SetWindowResizable(window, SDL_TRUE);
+    // Transparent texture that is drawn while a requested texture is still being decoded.
+    const uint32_t transparentPixel = 0;
+    placeholderTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, 1, 1);
+    SDL_UpdateTexture(placeholderTexture, nullptr, &transparentPixel, 4);
+    SDL_SetTextureBlendMode(placeholderTexture, SDL_BLENDMODE_BLEND);
 
-    Log::write("Renderer", LogLevel::info, "Initialized renderer");
+    Log::write("Renderer", LogLevel::info, headless ? "Initialized headless renderer" : "Initialized renderer");
 }
 
 void Renderer::update()
 {
+    present();
+    uploadTextures();
+}
+
+void Renderer::present()
+{
+    if (headlessMode)
+    {
+        // Draws are only counted, so the world can be updated as fast as possible.
+        drawCalls = static_cast<int>(renderQueue.size());
+        textureSwitches = 0;
+        unsortedTextureSwitches = 0;
+        clearQueue();
+        return;
+    }
+
+    flush();
+
     SDL_Rect dstRect;
     dstRect.x = (windowSize.x - screenSize.x) / 2;
     dstRect.y = (windowSize.y - screenSize.y) / 2;
@@ -79,6 +401,84 @@ void Renderer::update()
     SDL_RenderClear(renderer);
 }
 
+void Renderer::uploadTextures()
+{
+    uploadDecodedTextures(textureUploadBudget);
+}
+
+bool Renderer::isRenderThread()
+{
+    return std::this_thread::get_id() == renderThread;
+}
+
+void Renderer::runOnRenderThread(const std::function<void()>& task)
+{
+    if (isRenderThread())
+    {
+        task();
+        return;
+    }
+
+    // Only the simulation thread hands over tasks and it waits for each one, so there is never more than one.
+    std::unique_lock lock(renderTaskMutex);
+    renderTask = &task;
+    renderTaskCondition.notify_all();
+    renderTaskCondition.wait(lock, [] { return renderTask == nullptr; });
+}
+
+void Renderer::beginSimulation()
+{
+    std::lock_guard lock(renderTaskMutex);
+    simulationRunning = true;
+}
+
+void Renderer::endSimulation()
+{
+    std::lock_guard lock(renderTaskMutex);
+    simulationRunning = false;
+    renderTaskCondition.notify_all();
+}
+
+void Renderer::waitForSimulation()
+{
+    std::unique_lock lock(renderTaskMutex);
+    while (true)
+    {
+        renderTaskCondition.wait(lock, [] { return renderTask != nullptr || !simulationRunning; });
+        if (renderTask == nullptr) return;
+
+        const std::function<void()>* task = renderTask;
+        lock.unlock();
+        (*task)();
+        lock.lock();
+
+        renderTask = nullptr;
+        renderTaskCondition.notify_all();
+    }
+}
+
+static void pushText(const SDL_FRect& textRect, const TextLayout& layout, const SDL_Color& color, const SDL_FPoint& center, const float rotation)
+{
+    if (layout.size.x == 0 || layout.size.y == 0) return;
+
+    const float scaleX = textRect.w / layout.size.x;
+    const float scaleY = textRect.h / layout.size.y;
+
+    for (const GlyphQuad& quad : layout.quads)
+    {
+        SDL_FRect dstRect;
+        dstRect.x = textRect.x + quad.dstRect.x * scaleX;
+        dstRect.y = textRect.y + quad.dstRect.y * scaleY;
+        dstRect.w = quad.dstRect.w * scaleX;
+        dstRect.h = quad.dstRect.h * scaleY;
+
+        // Every glyph rotates around the rotation center of the whole text.
+        const SDL_FPoint glyphCenter = {textRect.x + center.x - dstRect.x, textRect.y + center.y - dstRect.y};
+
+        pushCommand(quad.texture, &quad.srcRect, dstRect, glyphCenter, rotation, color);
+    }
+}
+
 void Renderer::handleEvent(const SDL_Event* event)
 {
     if (event->window.event == SDL_WINDOWEVENT_RESIZED)
@@ -100,6 +500,8 @@ void Renderer::handleEvent(const SDL_Event* event)
             screenSize.y = windowSize.y * widthFactor / heightFactor;
         }
 
+        if (headlessMode) return;
+
         SDL_SetRenderTarget(renderer, nullptr);
         SDL_DestroyTexture(targetTexture);
         targetTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, screenSize.x, screenSize.y);
@@ -108,45 +510,97 @@ void Renderer::handleEvent(const SDL_Event* event)
     }
 }
 
+void Renderer::beginLayer(const RenderLayerType type)
+{
+    currentLayer++;
+
+    queuedWorldOffset = viewportSize / 2 - cameraPosition;
+    queuedWorldScale = Vector2f(screenSize.x / viewportSize.x, screenSize.y / viewportSize.y);
+    // Tiles overlap by a fraction of a pixel, so no gaps show between them.
+    if (queuedWorldScale.x > 0 && queuedWorldScale.y > 0)
+    {
+        queuedTileSize = Vector2f(1 + 0.04f / queuedWorldScale.x, 1 + 0.04f / queuedWorldScale.y);
+    }
+
+    switch (type)
+    {
+        case RenderLayerType::tiles:
+            currentLayerSortByTexture = true;
+            break;
+        case RenderLayerType::sprites:
+            currentLayerSortByTexture = spriteTextureSorting;
+            break;
+        case RenderLayerType::hud:
+            currentLayerSortByTexture = false;
+            break;
+    }
+}
+
 void Renderer::drawTile(const Vector2i& position, const SDL_Rect* srcRect, SDL_Texture* texture)
 {
     SDL_FRect dstRect;
-    dstRect.x = (position.x - cameraPosition.x + viewportSize.x / 2) * screenSize.x / viewportSize.x;
-    dstRect.y = (position.y - cameraPosition.y + viewportSize.y / 2) * screenSize.y / viewportSize.y;
-    dstRect.h = screenSize.y / viewportSize.y + 0.04f;
-    dstRect.w = screenSize.x / viewportSize.x + 0.04f;
+    dstRect.x = position.x;
+    dstRect.y = position.y;
+    dstRect.w = queuedTileSize.x;
+    dstRect.h = queuedTileSize.y;
 
-    SDL_RenderCopyF(renderer, texture, srcRect, &dstRect);
+    pushCommand(texture, srcRect, dstRect, {0, 0}, 0, {255, 255, 255, 255}, true);
 }
 
 void Renderer::drawHUD(const Vector2i& position, const Vector2i& scale, const SDL_Rect* srcRect, SDL_Texture* texture, const Vector2f& rotationCenter, const float rotation)
 {
-    SDL_Rect dstRect;
+    SDL_FRect dstRect;
     dstRect.x = position.x;
     dstRect.y = position.y;
     dstRect.w = scale.x;
     dstRect.h = scale.y;
 
-    SDL_Point centerPoint;
-    centerPoint.x = dstRect.w * rotationCenter.x;
-    centerPoint.y = dstRect.h * rotationCenter.y;
+    SDL_FPoint centerPoint;
+    centerPoint.x = static_cast<int>(dstRect.w * rotationCenter.x);
+    centerPoint.y = static_cast<int>(dstRect.h * rotationCenter.y);
 
-    SDL_RenderCopyEx(renderer, texture, srcRect, &dstRect, rotation, &centerPoint, SDL_FLIP_NONE);
+    pushCommand(texture, srcRect, dstRect, centerPoint, rotation);
 }
 
 void Renderer::drawSprite(const Vector2f& position, const Vector2f& scale, const SDL_Rect* srcRect, SDL_Texture* texture, const Vector2f& rotationCenter, const float rotation)
 {
     SDL_FRect dstRect;
-    dstRect.x = (position.x - scale.x / 2 - cameraPosition.x + viewportSize.x / 2) * screenSize.x / viewportSize.x;
-    dstRect.y = (position.y - scale.y / 2 - cameraPosition.y + viewportSize.y / 2) * screenSize.y / viewportSize.y;
-    dstRect.w = screenSize.x / viewportSize.x * scale.x;
-    dstRect.h = screenSize.y / viewportSize.y * scale.y;
+    dstRect.x = position.x - scale.x / 2;
+    dstRect.y = position.y - scale.y / 2;
+    dstRect.w = scale.x;
+    dstRect.h = scale.y;
+
+    pushCommand(texture, srcRect, dstRect, {rotationCenter.x, rotationCenter.y}, rotation, {255, 255, 255, 255}, true);
+}
+
+void Renderer::drawHUDText(const Vector2i& position, const Vector2i& scale, const TextLayout& layout, const SDL_Color& color, const Vector2f& rotationCenter, const float rotation)
+{
+    SDL_FRect textRect;
+    textRect.x = position.x;
+    textRect.y = position.y;
+    textRect.w = scale.x;
+    textRect.h = scale.y;
+
+    SDL_FPoint centerPoint;
+    centerPoint.x = static_cast<int>(textRect.w * rotationCenter.x);
+    centerPoint.y = static_cast<int>(textRect.h * rotationCenter.y);
+
+    pushText(textRect, layout, color, centerPoint, rotation);
+}
+
+void Renderer::drawSpriteText(const Vector2f& position, const Vector2f& scale, const TextLayout& layout, const SDL_Color& color, const Vector2f& rotationCenter, const float rotation)
+{
+    SDL_FRect textRect;
+    textRect.x = (position.x - scale.x / 2 - cameraPosition.x + viewportSize.x / 2) * screenSize.x / viewportSize.x;
+    textRect.y = (position.y - scale.y / 2 - cameraPosition.y + viewportSize.y / 2) * screenSize.y / viewportSize.y;
+    textRect.w = screenSize.x / viewportSize.x * scale.x;
+    textRect.h = screenSize.y / viewportSize.y * scale.y;
 
     SDL_FPoint centerPoint;
-    centerPoint.x = dstRect.w * rotationCenter.x;
-    centerPoint.y = dstRect.h * rotationCenter.y;
+    centerPoint.x = textRect.w * rotationCenter.x;
+    centerPoint.y = textRect.h * rotationCenter.y;
 
-    SDL_RenderCopyExF(renderer, texture, srcRect, &dstRect, rotation, &centerPoint, SDL_FLIP_NONE);
+    pushText(textRect, layout, color, centerPoint, rotation);
 }
 
 SDL_Texture* Renderer::createTexture(SDL_Surface* surface)
@@ -154,39 +608,292 @@ SDL_Texture* Renderer::createTexture(SDL_Surface* surface)
     return SDL_CreateTextureFromSurface(renderer, surface);
 }
 
-SDL_Texture* Renderer::loadTexture(const std::string& textureName, const std::string& path)
+TextureAtlas Renderer::createAtlas(const int size)
 {
-    if (textureMap.contains(textureName))
-        return textureMap[textureName];
+    return TextureAtlas(renderer, size);
+}
+
+void Renderer::destroyTexture(SDL_Texture* texture)
+{
+    if (!isRenderThread()) return onRenderThread([&] { destroyTexture(texture); });
+
+    if (texture == nullptr) return;
+
+    // Queued draws may still use the texture, so it is destroyed after the next flush.
+    if (renderQueue.empty())
+    {
+        SDL_DestroyTexture(texture);
+    }
+    else
+    {
+        destroyQueue.push_back(texture);
+    }
+}
 
-    SDL_Texture* texture = IMG_LoadTexture(renderer, path.c_str());
-    if (texture == nullptr)
+static bool packTexture(SDL_Surface* surface, TextureRegion& region)
+{
+    for (TextureAtlas& atlas : atlases)
+    {
+        if (atlas.insert(surface, region.rect))
+        {
+            region.texture = atlas.getTexture();
+            return true;
+        }
+    }
+
+    TextureAtlas& atlas = atlases.emplace_back(renderer, atlasSize);
+    if (!atlas.insert(surface, region.rect))
+    {
+        atlas.destroy();
+        atlases.pop_back();
+        return false;
+    }
+
+    region.texture = atlas.getTexture();
+    atlasRegionCounts[region.texture] = 0;
+    Log::write("Renderer", LogLevel::info, "Created texture atlas %i with size %i", static_cast<int>(atlases.size()) - 1, atlasSize);
+    return true;
+}
+
+static void unloadTexture(const std::string& textureName, const TextureRegion region)
+{
+    Log::write("Renderer", LogLevel::info, "Unloaded %s texture", textureName.c_str());
+
+    const auto atlasRegionCount = atlasRegionCounts.find(region.texture);
+    if (atlasRegionCount == atlasRegionCounts.end())
+    {
+        Renderer::destroyTexture(region.texture);
+        return;
+    }
+
+    packedTextureBytes -= static_cast<size_t>(region.rect.w) * region.rect.h * 4;
+
+    // The space is reused by the next textures packed into the atlas, and the atlas is freed with its last texture.
+    if (--atlasRegionCount->second > 0)
+    {
+        for (TextureAtlas& atlas : atlases)
+        {
+            if (atlas.getTexture() == region.texture) atlas.release(region.rect);
+        }
+        return;
+    }
+
+    atlasRegionCounts.erase(atlasRegionCount);
+    std::erase_if(atlases, [&region](const TextureAtlas& atlas) {
+        return atlas.getTexture() == region.texture;
+    });
+    Renderer::destroyTexture(region.texture);
+}
+
+static TextureRegion createRegion(SDL_Surface* loadedSurface)
+{
+    TextureRegion region = {nullptr, {0, 0, loadedSurface->w, loadedSurface->h}};
+
+    // Only images up to half the atlas size are packed, bigger ones would fill an atlas on their own.
+    if (atlasSize > 0 && std::max(loadedSurface->w, loadedSurface->h) <= atlasSize / 2)
+    {
+        const bool converted = loadedSurface->format->format != SDL_PIXELFORMAT_RGBA32;
+        SDL_Surface* surface = converted ? SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_RGBA32, 0) : loadedSurface;
+        if (surface != nullptr && packTexture(surface, region))
+        {
+            atlasRegionCounts[region.texture]++;
+            packedTextureBytes += static_cast<size_t>(region.rect.w) * region.rect.h * 4;
+        }
+        else
+        {
+            region.texture = nullptr;
+            region.rect = {0, 0, loadedSurface->w, loadedSurface->h};
+        }
+        if (converted) SDL_FreeSurface(surface);
+    }
+
+    if (region.texture == nullptr)
+    {
+        region.texture = SDL_CreateTextureFromSurface(renderer, loadedSurface);
+    }
+    return region;
+}
+
+static void insertTexture(const std::string& textureName, const TextureRegion& region, const int references)
+{
+    textureCache.insert(textureName, region, static_cast<size_t>(region.rect.w) * region.rect.h * 4, references);
+    Log::write("Renderer", LogLevel::info, "Loaded %s texture", textureName.c_str());
+}
+
+static void uploadDecodedTextures(const float budget)
+{
+    const auto start = std::chrono::steady_clock::now();
+    DecodedImage image;
+
+    // At least one texture is uploaded every frame, so loading always progresses.
+    do
+    {
+        if (!ImageDecoder::popDecoded(image)) break;
+
+        const auto pending = pendingTextures.find(image.name);
+        if (pending == pendingTextures.end())
+        {
+            SDL_FreeSurface(image.surface);
+            continue;
+        }
+
+        TextureRegion region = {nullptr, {0, 0, 0, 0}};
+        if (image.surface == nullptr)
+        {
+            Log::write("Renderer", LogLevel::error, "Can't load texture: %s / %s", image.name.c_str(), image.error.c_str());
+        }
+        else if (const TextureRegion* loadedRegion = textureCache.find(image.name))
+        {
+            // The texture was loaded synchronously in the meantime.
+            region = *loadedRegion;
+            for (int i = 0; i < pending->second.references; i++)
+            {
+                textureCache.retain(image.name);
+            }
+        }
+        else
+        {
+            region = createRegion(image.surface);
+            if (region.texture == nullptr)
+            {
+                Log::write("Renderer", LogLevel::error, "Can't load texture: %s / %s", image.name.c_str(), SDL_GetError());
+            }
+            else
+            {
+                insertTexture(image.name, region, pending->second.references);
+            }
+        }
+        SDL_FreeSurface(image.surface);
+
+        const std::vector<std::function<void(const TextureRegion&)>> callbacks = std::move(pending->second.callbacks);
+        pendingTextures.erase(pending);
+
+        if (region.texture == nullptr) continue;
+
+        for (const std::function<void(const TextureRegion&)>& callback : callbacks)
+        {
+            callback(region);
+        }
+    }
+    while (std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() < budget);
+}
+
+void Renderer::waitForTextures()
+{
+    if (!isRenderThread()) return onRenderThread([&] { waitForTextures(); });
+
+    while (!pendingTextures.empty())
+    {
+        uploadDecodedTextures(std::numeric_limits<float>::infinity());
+
+        if (!pendingTextures.empty())
+        {
+            SDL_Delay(1);
+        }
+    }
+}
+
+TextureRegion Renderer::loadTexture(const std::string& textureName, const std::string& path)
+{
+    if (!isRenderThread()) return onRenderThread([&] { return loadTexture(textureName, path); });
+
+    if (const TextureRegion* region = textureCache.find(textureName))
+    {
+        textureCache.retain(textureName);
+        return *region;
+    }
+
+    SDL_Surface* loadedSurface = ImageCache::load(path);
+    if (loadedSurface == nullptr)
+    {
+        Log::write("Renderer", LogLevel::error, "Can't load texture: %s / %s", textureName.c_str(), SDL_GetError());
+        return {nullptr, {0, 0, 0, 0}};
+    }
+
+    const TextureRegion region = createRegion(loadedSurface);
+    SDL_FreeSurface(loadedSurface);
+
+    if (region.texture == nullptr)
     {
         Log::write("Renderer", LogLevel::error, "Can't load texture: %s / %s", textureName.c_str(), SDL_GetError());
     }
     else
     {
-        textureMap.insert({textureName, texture});
-        Log::write("Renderer", LogLevel::info, "Loaded %s texture", textureName.c_str());
+        insertTexture(textureName, region, 1);
     }
-    return texture;
+    return region;
+}
+
+TextureRegion Renderer::requestTexture(const std::string& textureName, const std::string& path, const std::function<void(const TextureRegion&)>& onLoaded)
+{
+    if (!isRenderThread()) return onRenderThread([&] { return requestTexture(textureName, path, onLoaded); });
+
+    if (!asyncTextureLoading || textureCache.contains(textureName))
+    {
+        const TextureRegion region = loadTexture(textureName, path);
+        if (region.texture != nullptr) onLoaded(region);
+        return region;
+    }
+
+    auto [pending, inserted] = pendingTextures.try_emplace(textureName);
+    pending->second.references++;
+    pending->second.callbacks.push_back(onLoaded);
+
+    if (inserted)
+    {
+        ImageDecoder::request(textureName, path);
+    }
+    return {placeholderTexture, {0, 0, 1, 1}};
+}
+
+bool Renderer::isTextureLoading(const std::string& textureName)
+{
+    if (!isRenderThread()) return onRenderThread([&] { return isTextureLoading(textureName); });
+
+    return pendingTextures.contains(textureName);
+}
+
+void Renderer::releaseTexture(const std::string& textureName)
+{
+    if (!isRenderThread()) return onRenderThread([&] { releaseTexture(textureName); });
+
+    if (const auto pending = pendingTextures.find(textureName); pending != pendingTextures.end())
+    {
+        pending->second.references--;
+        return;
+    }
+
+    textureCache.release(textureName);
+}
+
+static void unloadFont(const std::pair<std::string, int>& key, TTF_Font* font)
+{
+    GlyphCache::unloadFont(font);
+    Log::write("Renderer", LogLevel::info, "Unloaded %s font with size %i", key.first.c_str(), key.second);
+    TTF_CloseFont(font);
 }
 
 TTF_Font* Renderer::loadFont(const std::string& fontName, int size)
 {
-    if (fontMap.contains({fontName, size}))
+    if (!isRenderThread()) return onRenderThread([&] { return loadFont(fontName, size); });
+
+    if (TTF_Font** font = fontCache.find({fontName, size}))
     {
-        return fontMap[{fontName, size}];
+        fontCache.retain({fontName, size});
+        return *font;
     }
 
-    std::string path = "./assets/Fonts/" + fontName + ".ttf";
+    std::string path = "Fonts/" + fontName + ".ttf";
 
-    if (!std::filesystem::exists(path))
+    if (!Assets::exists(path))
     {
-        path = "./assets/Fonts/" + fontName + ".otf";
+        path = "Fonts/" + fontName + ".otf";
     }
 
-    TTF_Font* font = TTF_OpenFont(path.c_str(), size);
+    // The font reads from the file while it is open, so SDL_ttf closes it with the font.
+    SDL_RWops* file = Assets::open(path);
+    const Sint64 fileSize = file ? SDL_RWsize(file) : 0;
+    TTF_Font* font = file ? TTF_OpenFontRW(file, 1, size) : nullptr;
 
     if (font == nullptr)
     {
@@ -195,29 +902,51 @@ TTF_Font* Renderer::loadFont(const std::string& fontName, int size)
     else
     {
         Log::write("Renderer", LogLevel::info, "Loaded %s font with size %i", fontName.c_str(), size);
-        fontMap.insert({{fontName, size}, font});
+
+        // Approximated by the size of the font file.
+        fontCache.insert({fontName, size}, font, fileSize > 0 ? static_cast<size_t>(fileSize) : 0, 1);
     }
     return font;
 }
 
+void Renderer::releaseFont(const std::string& fontName, const int size)
+{
+    if (!isRenderThread()) return onRenderThread([&] { releaseFont(fontName, size); });
+
+    fontCache.release({fontName, size});
+}
+
 void Renderer::unloadAllFonts()
 {
-    for (const auto& [key, font] : fontMap)
-    {
-        Log::write("Renderer", LogLevel::info, "Unloaded %s font with size %i", key.first.c_str(), key.second);
-        TTF_CloseFont(font);
-    }
-    fontMap.clear();
+    if (!isRenderThread()) return onRenderThread([&] { unloadAllFonts(); });
+
+    GlyphCache::unloadAll();
+    fontCache.clear();
+}
+
+void Renderer::unloadUnusedSprites()
+{
+    if (!isRenderThread()) return onRenderThread([&] { unloadUnusedSprites(); });
+
+    SpriteSheetCache::unloadUnused();
 }
 
 void Renderer::unloadAllTextures()
 {
-    for (const auto& [textureName, texture] : textureMap)
+    if (!isRenderThread()) return onRenderThread([&] { unloadAllTextures(); });
+
+    SpriteSheetCache::unloadAll();
+
+    pendingTextures.clear();
+    textureCache.clear();
+
+    for (TextureAtlas& atlas : atlases)
     {
-        Log::write("Renderer", LogLevel::info, "Unloaded %s texture", textureName.c_str());
-        SDL_DestroyTexture(texture);
+        destroyTexture(atlas.getTexture());
     }
-    textureMap.clear();
+    atlases.clear();
+    atlasRegionCounts.clear();
+    packedTextureBytes = 0;
 }
 
 Vector2f Renderer::getCameraPosition()
@@ -240,8 +969,68 @@ Vector2i Renderer::getWindowSize()
     return windowSize;
 }
 
+int Renderer::getDrawCalls()
+{
+    if (!isRenderThread()) return onRenderThread([&] { return getDrawCalls(); });
+
+    return drawCalls;
+}
+
+size_t Renderer::getTextureMemory()
+{
+    if (!isRenderThread()) return onRenderThread([&] { return getTextureMemory(); });
+
+    size_t atlasBytes = 0;
+    for (const TextureAtlas& atlas : atlases)
+    {
+        atlasBytes += atlas.getMemory();
+    }
+
+    return textureCache.getResidentBytes() - packedTextureBytes + atlasBytes;
+}
+
+size_t Renderer::getFontMemory()
+{
+    if (!isRenderThread()) return onRenderThread([&] { return getFontMemory(); });
+
+    return fontCache.getResidentBytes();
+}
+
+int Renderer::getAtlasCount()
+{
+    if (!isRenderThread()) return onRenderThread([&] { return getAtlasCount(); });
+
+    return static_cast<int>(atlases.size());
+}
+
+float Renderer::getAtlasOccupancy(const int index)
+{
+    if (!isRenderThread()) return onRenderThread([&] { return getAtlasOccupancy(index); });
+
+    if (index < 0 || index >= static_cast<int>(atlases.size())) return 0.0f;
+
+    return atlases[index].getOccupancy();
+}
+
+int Renderer::getTextureSwitches()
+{
+    if (!isRenderThread()) return onRenderThread([&] { return getTextureSwitches(); });
+
+    return textureSwitches;
+}
+
+int Renderer::getUnsortedTextureSwitches()
+{
+    if (!isRenderThread()) return onRenderThread([&] { return getUnsortedTextureSwitches(); });
+
+    return unsortedTextureSwitches;
+}
+
 void Renderer::setFullscreen(const bool fullscreen)
 {
+    if (!isRenderThread()) return onRenderThread([&] { setFullscreen(fullscreen); });
+    if (headlessMode) return;
+
     if (fullscreen)
     {
         SDL_Rect displaySize;
@@ -262,6 +1051,9 @@ void Renderer::setFullscreen(const bool fullscreen)
 
 void Renderer::setWindowIcon(const std::string& path)
 {
+    if (!isRenderThread()) return onRenderThread([&] { setWindowIcon(path); });
+    if (headlessMode) return;
+
     SDL_Surface* surface = IMG_Load(path.c_str());
     if (surface == nullptr)
     {
@@ -274,6 +1066,9 @@ void Renderer::setWindowIcon(const std::string& path)
 
 void Renderer::setWindowTitle(const std::string& title)
 {
+    if (!isRenderThread()) return onRenderThread([&] { setWindowTitle(title); });
+    if (headlessMode) return;
+
     SDL_SetWindowTitle(window, title.c_str());
 }
 
@@ -288,6 +1083,72 @@ void Renderer::setCameraPosition(const Vector2f& position)
     cameraPosition = position;
 }
 
+void Renderer::setTextureBudget(const size_t bytes)
+{
+    if (!isRenderThread()) return onRenderThread([&] { setTextureBudget(bytes); });
+
+    textureCache.setBudget(bytes);
+}
+
+void Renderer::setFontBudget(const size_t bytes)
+{
+    if (!isRenderThread()) return onRenderThread([&] { setFontBudget(bytes); });
+
+    fontCache.setBudget(bytes);
+}
+
+void Renderer::setTextCacheBudget(const size_t bytes)
+{
+    if (!isRenderThread()) return onRenderThread([&] { setTextCacheBudget(bytes); });
+
+    GlyphCache::setLayoutCacheBudget(bytes);
+}
+
+void Renderer::setAsyncTextureLoading(const bool enabled)
+{
+    if (!isRenderThread()) return onRenderThread([&] { setAsyncTextureLoading(enabled); });
+
+    asyncTextureLoading = enabled;
+}
+
+void Renderer::setTextureUploadBudget(const float milliseconds)
+{
+    if (!isRenderThread()) return onRenderThread([&] { setTextureUploadBudget(milliseconds); });
+
+    textureUploadBudget = milliseconds;
+}
+
+void Renderer::setTextureDiskCache(const bool enabled)
+{
+    ImageCache::setEnabled(enabled);
+}
+
+void Renderer::setTextureDiskCacheBudget(const size_t bytes)
+{
+    ImageCache::setBudget(bytes);
+}
+
+void Renderer::setAtlasSize(const int size)
+{
+    if (!isRenderThread()) return onRenderThread([&] { setAtlasSize(size); });
+
+    atlasSize = std::max(size, 0);
+}
+
+void Renderer::setGeometryBatching(const bool enabled)
+{
+    if (!isRenderThread()) return onRenderThread([&] { setGeometryBatching(enabled); });
+
+    geometryBatching = enabled;
+}
+
+void Renderer::setSpriteTextureSorting(const bool enabled)
+{
+    if (!isRenderThread()) return onRenderThread([&] { setSpriteTextureSorting(enabled); });
+
+    spriteTextureSorting = enabled;
+}
+
 void Renderer::setViewportSize(const float width, const float height)
 {
     viewportSize.x = width;
@@ -301,11 +1162,21 @@ void Renderer::setViewportSize(const Vector2f& size)
 
 void Renderer::cleanUp()
 {
+    renderQueue.clear();
+    for (SDL_Texture* texture : destroyQueue)
+    {
+        SDL_DestroyTexture(texture);
+    }
+    destroyQueue.clear();
+
+    ImageDecoder::shutdown();
     unloadAllFonts();
     unloadAllTextures();
+    SDL_DestroyTexture(placeholderTexture);
     SDL_DestroyTexture(targetTexture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
+    SDL_FreeSurface(headlessSurface);
     IMG_Quit();
     TTF_Quit();
 }
\ No newline at end of file
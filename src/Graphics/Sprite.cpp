@@ -1,80 +1,105 @@
 #include "Sprite.hpp"
 
-#include <fstream>
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <unordered_map>
 
-#include <nlohmann/json.hpp>
 #include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "Assets.hpp"
 #include "Bee.hpp"
 #include "Log.hpp"
+#include "GlyphCache.hpp"
 #include "Renderer.hpp"
+#include "SpriteSheet.hpp"
 #include "Math/Vector2f.hpp"
 #include "Math/Vector2i.hpp"
 
+static constexpr uint8_t collisionMaskAlphaThreshold = 128;
+static std::unordered_map<std::string, std::vector<CollisionMask>> collisionMaskMap;
+
 Sprite::Sprite() = default;
 
 void Sprite::setSprite(const std::string& spriteName)
 {
-    std::string jsonFilePath = "./assets/Sprites/" + spriteName + ".json";
-    std::string pngFilePath = "./assets/Sprites/" + spriteName + ".png";
-
-    texture = Renderer::loadTexture(spriteName, pngFilePath);
+    spriteSheet = SpriteSheetCache::load(spriteName);
+    this->spriteName = spriteName;
+    collisionMasks = nullptr;
 
-    currentAnimation.start = 0;
-    currentAnimation.end = 0;
-    currentAnimation.direction = AnimationDirection::none;
-    frameTags.insert({"no_animation", currentAnimation});
+    currentSprite = 0;
+    currentAnimation = spriteSheet->frameTags.at("no_animation");
+    currentAnimationName.clear();
 
-    std::ifstream jsonFile(jsonFilePath);
-
-    if (jsonFile.fail()) return;
+    if (collisionMaskEnabled) loadCollisionMasks();
+}
 
-    nlohmann::json spriteData = nlohmann::json::parse(jsonFile);
+void Sprite::loadCollisionMasks()
+{
+    if (collisionMaskMap.contains(spriteName))
+    {
+        collisionMasks = &collisionMaskMap.at(spriteName);
+        return;
+    }
 
-    for (const nlohmann::json& spriteFrameJson : spriteData["frames"])
+    SDL_Surface* image = IMG_Load_RW(Assets::open("Sprites/" + spriteName + ".png"), 1);
+    if (image == nullptr)
     {
-        AnimationSpriteFrame spriteFrame;
-        spriteFrame.x = spriteFrameJson["frame"]["x"].get<int>();
-        spriteFrame.y = spriteFrameJson["frame"]["y"].get<int>();
-        spriteFrame.w = spriteFrameJson["frame"]["w"].get<int>();
-        spriteFrame.h = spriteFrameJson["frame"]["h"].get<int>();
-        spriteFrame.duration = spriteFrameJson["duration"].get<int>();
+        Log::write("Sprite", LogLevel::error, "Can't load collision mask: %s / %s", spriteName.c_str(), SDL_GetError());
+        return;
+    }
 
-        sprites.push_back(spriteFrame);
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(image);
+    if (surface == nullptr)
+    {
+        Log::write("Sprite", LogLevel::error, "Can't convert collision mask: %s / %s", spriteName.c_str(), SDL_GetError());
+        return;
     }
 
-    for (const nlohmann::json& frameTagJson : spriteData["meta"]["frameTags"])
+    const std::vector<AnimationSpriteFrame>& frames = spriteSheet->frames;
+
+    std::vector<CollisionMask> masks;
+    SDL_LockSurface(surface);
+    for (const AnimationSpriteFrame& frame : frames)
     {
-        FrameTag frameTag;
-        frameTag.start = frameTagJson["from"].get<int>();
-        frameTag.end = frameTagJson["to"].get<int>();
+        CollisionMask mask;
+        mask.width = std::max(0, std::min(frame.w, surface->w - frame.x));
+        mask.height = std::max(0, std::min(frame.h, surface->h - frame.y));
+        mask.wordsPerRow = (mask.width + 63) / 64;
+        mask.bits.assign(mask.wordsPerRow * mask.height, 0);
 
-        if (std::string direction = frameTagJson["direction"].get<std::string>(); direction == "forward")
-        {
-            frameTag.direction = AnimationDirection::forward;
-        }
-        else if (direction == "reverse")
+        for (int y = 0; y < mask.height; y++)
         {
-            frameTag.direction = AnimationDirection::reverse;
-        }
-        else if (direction == "pingpong")
-        {
-            frameTag.direction = AnimationDirection::pingPong;
-        }
+            const uint8_t* row = static_cast<const uint8_t*>(surface->pixels) + (frame.y + y) * surface->pitch + frame.x * 4;
+            uint64_t* bits = &mask.bits[y * mask.wordsPerRow];
 
-        frameTags.insert({frameTagJson["name"].get<std::string>(), frameTag});
+            for (int x = 0; x < mask.width; x++)
+            {
+                if (row[x * 4 + 3] >= collisionMaskAlphaThreshold)
+                {
+                    bits[x / 64] |= 1ull << (x % 64);
+                }
+            }
+        }
+        masks.push_back(std::move(mask));
     }
+    SDL_UnlockSurface(surface);
+    SDL_FreeSurface(surface);
+
+    collisionMasks = &collisionMaskMap.insert({spriteName, std::move(masks)}).first->second;
+    Log::write("Sprite", LogLevel::info, "Created %s collision mask", spriteName.c_str());
 }
 
 void Sprite::setAnimation(const std::string& animationName)
 {
     if (currentAnimationName == animationName) return;
 
-    if (frameTags.contains(animationName))
+    if (spriteSheet && spriteSheet->frameTags.contains(animationName))
     {
-        currentAnimation = frameTags.at(animationName);
+        currentAnimation = spriteSheet->frameTags.at(animationName);
     }
     else
     {
@@ -97,45 +122,83 @@ void Sprite::setAnimation(const std::string& animationName)
 void Sprite::setFont(const std::string& fontName, const int size)
 {
     font = Renderer::loadFont(fontName, size);
+
+    if (!spriteSheet && !text.empty())
+    {
+        textLayout = GlyphCache::layoutText(font, text);
+    }
+
+    // The previous font is released last, so its glyphs are no longer in use if it gets unloaded.
+    if (!this->fontName.empty())
+    {
+        Renderer::releaseFont(this->fontName, fontSize);
+    }
+    this->fontName = fontName;
+    fontSize = size;
 }
 
 void Sprite::setText(const std::string& text, const uint8_t red, const uint8_t green, const uint8_t blue, const uint8_t alpha)
 {
-    if (this->text == text) return;
+    textColor = {red, green, blue, alpha};
 
+    if (this->text == text && !spriteSheet) return;
+
+    // Text is drawn from glyph atlases, so changing it only looks up or redoes the layout.
     this->text = text;
-    SDL_DestroyTexture(texture);
+    spriteSheet = nullptr;
+    collisionMasks = nullptr;
+    textLayout = GlyphCache::layoutText(font, text);
+}
 
-    const SDL_Color color = {red, green, blue, alpha};
-    SDL_Surface* surface = TTF_RenderUTF8_Blended_Wrapped(font, text.c_str(), color, 0);
-    texture = Renderer::createTexture(surface);
-    SDL_FreeSurface(surface);
-    SDL_SetTextureScaleMode(texture, SDL_ScaleModeBest);
+void Sprite::setCollisionMaskEnabled(const bool enabled)
+{
+    collisionMaskEnabled = enabled;
+
+    if (!enabled)
+    {
+        collisionMasks = nullptr;
+    }
+    else if (!collisionMasks && spriteSheet)
+    {
+        loadCollisionMasks();
+    }
+}
+
+const CollisionMask* Sprite::getCollisionMask() const
+{
+    if (!collisionMasks || currentSprite >= static_cast<int>(collisionMasks->size()))
+        return nullptr;
+
+    return &(*collisionMasks)[currentSprite];
 }
 
 Vector2i Sprite::getTextureSize() const
 {
     Vector2i textureSize;
 
-    if (sprites.empty())
+    if (!spriteSheet)
+    {
+        textureSize = textLayout ? textLayout->size : Vector2i(0, 0);
+    }
+    else if (spriteSheet->frames.empty())
     {
-        SDL_QueryTexture(texture, nullptr, nullptr, &textureSize.x, &textureSize.y);
+        SDL_QueryTexture(spriteSheet->texture, nullptr, nullptr, &textureSize.x, &textureSize.y);
     }
     else
     {
-        textureSize.x = sprites[0].w;
-        textureSize.y = sprites[0].h;
+        textureSize.x = spriteSheet->frames[0].w;
+        textureSize.y = spriteSheet->frames[0].h;
     }
 
     return textureSize;
 }
 
-void Sprite::updateInternal()
+void Sprite::updateAnimation()
 {
-    if (sprites.empty() || currentAnimation.direction == AnimationDirection::none)
+    if (!spriteSheet || spriteSheet->frames.empty() || currentAnimation.direction == AnimationDirection::none)
         return;
 
-    if (const uint32_t currentTime = Bee::getTime(); frameStartTime + sprites[currentSprite].duration <= currentTime)
+    if (const uint32_t currentTime = Bee::getTime(); frameStartTime + spriteSheet->frames[currentSprite].duration <= currentTime)
     {
         frameStartTime = currentTime;
 
@@ -176,16 +239,50 @@ void Sprite::updateInternal()
     }
 }
 
+bool Sprite::getFrameRect(SDL_Rect& rect) const
+{
+    if (!spriteSheet || currentSprite >= static_cast<int>(spriteSheet->frames.size()))
+        return false;
+
+    // Frames are relative to the sprite image, which may be packed anywhere in an atlas.
+    const AnimationSpriteFrame& frame = spriteSheet->frames[currentSprite];
+    rect.x = frame.x + spriteSheet->textureOffset.x;
+    rect.y = frame.y + spriteSheet->textureOffset.y;
+    rect.w = frame.w;
+    rect.h = frame.h;
+    return true;
+}
+
 void Sprite::updateInternalHUD(const Vector2i& position, const Vector2i& scale, const Vector2f& rotationCenter, const float rotation)
 {
-    updateInternal();
-    Renderer::drawHUD(position, scale, reinterpret_cast<SDL_Rect *>(&sprites[currentSprite]), texture, rotationCenter, rotation);
+    if (spriteSheet)
+    {
+        SDL_Rect frameRect;
+        Renderer::drawHUD(position, scale, getFrameRect(frameRect) ? &frameRect : nullptr, spriteSheet->texture, rotationCenter, rotation);
+    }
+    else if (textLayout)
+    {
+        Renderer::drawHUDText(position, scale, *textLayout, textColor, rotationCenter, rotation);
+    }
 }
 
 void Sprite::updateInternalEntity(const Vector2f& position, const Vector2f& scale, const Vector2f& rotationCenter, const float rotation)
 {
-    updateInternal();
-    Renderer::drawSprite(position, scale, reinterpret_cast<SDL_Rect *>(&sprites[currentSprite]), texture, rotationCenter, rotation);
+    if (spriteSheet)
+    {
+        SDL_Rect frameRect;
+        Renderer::drawSprite(position, scale, getFrameRect(frameRect) ? &frameRect : nullptr, spriteSheet->texture, rotationCenter, rotation);
+    }
+    else if (textLayout)
+    {
+        Renderer::drawSpriteText(position, scale, *textLayout, textColor, rotationCenter, rotation);
+    }
 }
 
-Sprite::~Sprite() = default;
\ No newline at end of file
+Sprite::~Sprite()
+{
+    if (!fontName.empty())
+    {
+        Renderer::releaseFont(fontName, fontSize);
+    }
+}
\ No newline at end of file
@@ -1,13 +1,16 @@
 #pragma once
 
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "Collision/CollisionMask.hpp"
 #include "Graphics/Animation.hpp"
+#include "Graphics/GlyphCache.hpp"
+#include "Graphics/SpriteSheet.hpp"
 #include "Math/Vector2f.hpp"
 #include "Math/Vector2i.hpp"
 
@@ -19,21 +22,30 @@ public:
     void setAnimation(const std::string& animationName);
     void setFont(const std::string& fontName, int size);
     void setText(const std::string& text, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha);
+    void setCollisionMaskEnabled(bool enabled);
+    const CollisionMask* getCollisionMask() const;
     Vector2i getTextureSize() const;
+    void updateAnimation();
     void updateInternalEntity(const Vector2f& position, const Vector2f& scale, const Vector2f& rotationCenter, float rotation);
     void updateInternalHUD(const Vector2i& position, const Vector2i& scale, const Vector2f& rotationCenter, float rotation);
     ~Sprite();
 
 private:
+    bool collisionMaskEnabled = false;
     int currentSprite = 0;
+    int fontSize = 0;
     uint32_t frameStartTime = 0;
+    std::string spriteName;
+    std::string fontName;
     std::string currentAnimationName;
     std::string text;
-    std::vector<AnimationSpriteFrame> sprites;
-    std::unordered_map<std::string, FrameTag> frameTags;
-    SDL_Texture* texture = nullptr;
+    std::shared_ptr<const TextLayout> textLayout;
+    SDL_Color textColor = {255, 255, 255, 255};
+    std::shared_ptr<const SpriteSheet> spriteSheet;
+    const std::vector<CollisionMask>* collisionMasks = nullptr;
     TTF_Font* font = nullptr;
     AnimationDirection currentAnimationDirection = AnimationDirection::none;
     FrameTag currentAnimation = {};
-    void updateInternal();
+    bool getFrameRect(SDL_Rect& rect) const;
+    void loadCollisionMasks();
 };
\ No newline at end of file
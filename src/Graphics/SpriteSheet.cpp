@@ -0,0 +1,265 @@
+#include "SpriteSheet.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "Assets.hpp"
+#include "Assets/Hash.hpp"
+#include "Log.hpp"
+#include "Renderer.hpp"
+
+// Sheets are only cached while a sprite uses them, the last sprite releases the texture so the texture budget can evict it.
+static std::unordered_map<std::string, std::weak_ptr<SpriteSheet>> spriteSheetMap;
+// Incremented when all textures are unloaded, older sheets don't hold a texture reference anymore.
+static uint64_t cacheGeneration = 0;
+
+// Reads the image size from the PNG header, so a sprite without JSON gets its frame before the image is decoded.
+static bool readPNGSize(const std::string& path, int& width, int& height)
+{
+    SDL_RWops* file = Assets::open(path);
+    if (file == nullptr) return false;
+
+    uint8_t header[24];
+    const size_t read = SDL_RWread(file, header, sizeof(header), 1);
+    SDL_RWclose(file);
+
+    if (read != 1) return false;
+    if (header[1] != 'P' || header[2] != 'N' || header[3] != 'G' || header[12] != 'I' || header[13] != 'H' || header[14] != 'D' || header[15] != 'R') return false;
+
+    width = header[16] << 24 | header[17] << 16 | header[18] << 8 | header[19];
+    height = header[20] << 24 | header[21] << 16 | header[22] << 8 | header[23];
+    return true;
+}
+
+// Parsed sprite sheets are cached in a binary file in native byte order, keyed by a hash of the JSON.
+static constexpr char binarySheetMagic[4] = {'B', 'S', 'P', 'R'};
+static constexpr uint32_t binarySheetVersion = 1;
+static constexpr uint32_t maxBinarySheetFrames = 65536;
+
+template <typename T>
+static bool readValue(std::ifstream& file, T& value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+template <typename T>
+static void writeValue(std::ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static bool readBinarySheet(const std::string& path, const uint64_t jsonHash, SpriteSheet& spriteSheet)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char magic[4];
+    uint32_t version;
+    uint64_t hash;
+    uint32_t frameCount;
+    uint32_t tagCount;
+
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, binarySheetMagic, sizeof(magic)) != 0) return false;
+    if (!readValue(file, version) || version != binarySheetVersion) return false;
+    if (!readValue(file, hash) || hash != jsonHash) return false;
+    if (!readValue(file, frameCount) || !readValue(file, tagCount) || frameCount > maxBinarySheetFrames) return false;
+
+    std::vector<AnimationSpriteFrame> frames(frameCount);
+    if (frameCount > 0 && !file.read(reinterpret_cast<char*>(frames.data()), static_cast<std::streamsize>(frameCount * sizeof(AnimationSpriteFrame)))) return false;
+
+    std::unordered_map<std::string, FrameTag> frameTags;
+    for (uint32_t i = 0; i < tagCount; i++)
+    {
+        FrameTag frameTag;
+        uint8_t direction;
+        uint16_t nameLength;
+
+        if (!readValue(file, frameTag.start) || !readValue(file, frameTag.end) || !readValue(file, direction) || !readValue(file, nameLength)) return false;
+        if (direction > static_cast<uint8_t>(AnimationDirection::pingPong)) return false;
+
+        std::string name(nameLength, '\0');
+        if (!file.read(name.data(), nameLength)) return false;
+
+        frameTag.direction = static_cast<AnimationDirection>(direction);
+        frameTags.insert({std::move(name), frameTag});
+    }
+
+    spriteSheet.frames = std::move(frames);
+    spriteSheet.frameTags.merge(frameTags);
+    return true;
+}
+
+static void writeBinarySheet(const std::string& path, const uint64_t jsonHash, const SpriteSheet& spriteSheet)
+{
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        Log::write("Sprite", LogLevel::warning, "Can't write sprite sheet cache: %s", path.c_str());
+        return;
+    }
+
+    file.write(binarySheetMagic, sizeof(binarySheetMagic));
+    writeValue(file, binarySheetVersion);
+    writeValue(file, jsonHash);
+    writeValue(file, static_cast<uint32_t>(spriteSheet.frames.size()));
+    writeValue(file, static_cast<uint32_t>(spriteSheet.frameTags.size() - spriteSheet.frameTags.count("no_animation")));
+    file.write(reinterpret_cast<const char*>(spriteSheet.frames.data()), static_cast<std::streamsize>(spriteSheet.frames.size() * sizeof(AnimationSpriteFrame)));
+
+    for (const auto& [name, frameTag] : spriteSheet.frameTags)
+    {
+        if (name == "no_animation") continue;
+
+        writeValue(file, frameTag.start);
+        writeValue(file, frameTag.end);
+        writeValue(file, static_cast<uint8_t>(frameTag.direction));
+        writeValue(file, static_cast<uint16_t>(name.size()));
+        file.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+}
+
+static void parseJsonSheet(const std::string& json, SpriteSheet& spriteSheet)
+{
+    nlohmann::json spriteData = nlohmann::json::parse(json);
+
+    for (const nlohmann::json& spriteFrameJson : spriteData["frames"])
+    {
+        AnimationSpriteFrame spriteFrame;
+        spriteFrame.x = spriteFrameJson["frame"]["x"].get<int>();
+        spriteFrame.y = spriteFrameJson["frame"]["y"].get<int>();
+        spriteFrame.w = spriteFrameJson["frame"]["w"].get<int>();
+        spriteFrame.h = spriteFrameJson["frame"]["h"].get<int>();
+        spriteFrame.duration = spriteFrameJson["duration"].get<int>();
+
+        spriteSheet.frames.push_back(spriteFrame);
+    }
+
+    for (const nlohmann::json& frameTagJson : spriteData["meta"]["frameTags"])
+    {
+        FrameTag frameTag;
+        frameTag.start = frameTagJson["from"].get<int>();
+        frameTag.end = frameTagJson["to"].get<int>();
+
+        if (std::string direction = frameTagJson["direction"].get<std::string>(); direction == "forward")
+        {
+            frameTag.direction = AnimationDirection::forward;
+        }
+        else if (direction == "reverse")
+        {
+            frameTag.direction = AnimationDirection::reverse;
+        }
+        else if (direction == "pingpong")
+        {
+            frameTag.direction = AnimationDirection::pingPong;
+        }
+
+        spriteSheet.frameTags.insert({frameTagJson["name"].get<std::string>(), frameTag});
+    }
+}
+
+static void releaseSpriteSheet(const SpriteSheet* spriteSheet, const uint64_t generation)
+{
+    if (generation == cacheGeneration)
+    {
+        Renderer::releaseTexture(spriteSheet->name);
+
+        // The sheet may have been loaded again while this one was being released.
+        if (const auto iterator = spriteSheetMap.find(spriteSheet->name); iterator != spriteSheetMap.end() && iterator->second.expired())
+            spriteSheetMap.erase(iterator);
+    }
+
+    delete spriteSheet;
+}
+
+std::shared_ptr<const SpriteSheet> SpriteSheetCache::load(const std::string& spriteName)
+{
+    if (const auto iterator = spriteSheetMap.find(spriteName); iterator != spriteSheetMap.end())
+    {
+        if (std::shared_ptr<SpriteSheet> spriteSheet = iterator->second.lock()) return spriteSheet;
+    }
+
+    const std::string jsonFilePath = "Sprites/" + spriteName + ".json";
+    const std::string pngFilePath = "Sprites/" + spriteName + ".png";
+
+    const uint64_t generation = cacheGeneration;
+    const std::shared_ptr<SpriteSheet> spriteSheet(new SpriteSheet, [generation](const SpriteSheet* spriteSheet) {
+        releaseSpriteSheet(spriteSheet, generation);
+    });
+    spriteSheet->name = spriteName;
+    spriteSheet->frameTags.insert({"no_animation", FrameTag()});
+
+    std::string jsonFile;
+    const bool hasJson = Assets::readFile(jsonFilePath, jsonFile);
+    TextureRegion region;
+    int width = 0;
+    int height = 0;
+
+    if (!hasJson && !readPNGSize(pngFilePath, width, height))
+    {
+        region = Renderer::loadTexture(spriteName, pngFilePath);
+        width = region.rect.w;
+        height = region.rect.h;
+    }
+    else
+    {
+        // Until the image is decoded the sheet draws the placeholder texture.
+        const std::weak_ptr<SpriteSheet> weakSpriteSheet = spriteSheet;
+        region = Renderer::requestTexture(spriteName, pngFilePath, [weakSpriteSheet](const TextureRegion& loadedRegion) {
+            if (const std::shared_ptr<SpriteSheet> loadedSpriteSheet = weakSpriteSheet.lock())
+            {
+                loadedSpriteSheet->texture = loadedRegion.texture;
+                loadedSpriteSheet->textureOffset = Vector2i(loadedRegion.rect.x, loadedRegion.rect.y);
+            }
+        });
+    }
+
+    spriteSheet->texture = region.texture;
+    spriteSheet->textureOffset = Vector2i(region.rect.x, region.rect.y);
+
+    if (!hasJson)
+    {
+        spriteSheet->frames.push_back({0, 0, width, height, 0});
+    }
+    else if (Assets::isEmbedded())
+    {
+        // Embedded assets are meant to load without any file access.
+        parseJsonSheet(jsonFile, *spriteSheet);
+    }
+    else
+    {
+        const std::string cachePath = "./cache/Sprites/" + spriteName + ".bin";
+        const uint64_t jsonHash = hashData(jsonFile.data(), jsonFile.size());
+
+        if (!readBinarySheet(cachePath, jsonHash, *spriteSheet))
+        {
+            parseJsonSheet(jsonFile, *spriteSheet);
+            writeBinarySheet(cachePath, jsonHash, *spriteSheet);
+        }
+    }
+
+    spriteSheetMap[spriteName] = spriteSheet;
+    Log::write("Sprite", LogLevel::info, "Loaded %s sprite sheet", spriteName.c_str());
+    return spriteSheet;
+}
+
+void SpriteSheetCache::unloadUnused()
+{
+    std::erase_if(spriteSheetMap, [](const auto& entry) {
+        return entry.second.expired();
+    });
+}
+
+void SpriteSheetCache::unloadAll()
+{
+    cacheGeneration++;
+    spriteSheetMap.clear();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+#include "Graphics/Animation.hpp"
+#include "Math/Vector2i.hpp"
+
+struct SpriteSheet
+{
+    std::string name;
+    SDL_Texture* texture = nullptr;
+    Vector2i textureOffset;
+    std::vector<AnimationSpriteFrame> frames;
+    std::unordered_map<std::string, FrameTag> frameTags;
+};
+
+namespace SpriteSheetCache
+{
+    std::shared_ptr<const SpriteSheet> load(const std::string& spriteName);
+    void unloadUnused();
+    void unloadAll();
+};
@@ -0,0 +1,206 @@
+#include "TextureAtlas.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "Log.hpp"
+
+// Transparent gap between images so filtering never samples a neighbour.
+static constexpr int padding = 1;
+
+TextureAtlas::TextureAtlas(SDL_Renderer* renderer, const int size)
+    : size(size)
+{
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, size, size);
+    if (texture == nullptr)
+    {
+        Log::write("Renderer", LogLevel::error, "Can't create texture atlas: %s", SDL_GetError());
+        return;
+    }
+
+    const std::vector<uint32_t> emptyPixels(static_cast<size_t>(size) * size, 0);
+    SDL_UpdateTexture(texture, nullptr, emptyPixels.data(), size * 4);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    skyline.push_back({0, 0, size});
+}
+
+int TextureAtlas::fit(const size_t index, const int width, const int height) const
+{
+    const int x = skyline[index].x;
+    if (x + width > size) return -1;
+
+    int y = 0;
+    int remainingWidth = width;
+
+    for (size_t i = index; remainingWidth > 0; i++)
+    {
+        if (i >= skyline.size()) return -1;
+
+        y = std::max(y, skyline[i].y);
+        if (y + height > size) return -1;
+
+        remainingWidth -= skyline[i].width;
+    }
+
+    return y;
+}
+
+bool TextureAtlas::insertFree(const int width, const int height, SDL_Rect& rect)
+{
+    // Best fit: the smallest released rectangle the image fits into.
+    int bestIndex = -1;
+    long bestArea = LONG_MAX;
+
+    for (size_t i = 0; i < freeRects.size(); i++)
+    {
+        const SDL_Rect& freeRect = freeRects[i];
+        const long area = static_cast<long>(freeRect.w) * freeRect.h;
+        if (freeRect.w >= width && freeRect.h >= height && area < bestArea)
+        {
+            bestIndex = static_cast<int>(i);
+            bestArea = area;
+        }
+    }
+
+    if (bestIndex < 0) return false;
+
+    const SDL_Rect freeRect = freeRects[bestIndex];
+    freeRects.erase(freeRects.begin() + bestIndex);
+
+    // The rest is split along the shorter leftover, which keeps the bigger piece as large as possible.
+    const int rightWidth = freeRect.w - width;
+    const int bottomHeight = freeRect.h - height;
+    SDL_Rect right = {freeRect.x + width, freeRect.y, rightWidth, height};
+    SDL_Rect bottom = {freeRect.x, freeRect.y + height, freeRect.w, bottomHeight};
+    if (rightWidth > bottomHeight)
+    {
+        right.h = freeRect.h;
+        bottom.w = width;
+    }
+    if (right.w > padding && right.h > padding) freeRects.push_back(right);
+    if (bottom.w > padding && bottom.h > padding) freeRects.push_back(bottom);
+
+    rect.x = freeRect.x;
+    rect.y = freeRect.y;
+    return true;
+}
+
+bool TextureAtlas::insert(SDL_Surface* surface, SDL_Rect& rect)
+{
+    if (texture == nullptr) return false;
+
+    const int width = surface->w + padding;
+    const int height = surface->h + padding;
+
+    if (insertFree(width, height, rect))
+    {
+        rect.w = surface->w;
+        rect.h = surface->h;
+
+        SDL_UpdateTexture(texture, &rect, surface->pixels, surface->pitch);
+        usedArea += static_cast<long>(surface->w) * surface->h;
+
+        return true;
+    }
+
+    // Bottom left skyline: take the lowest position, break ties with the narrowest segment.
+    int bestIndex = -1;
+    int bestBottom = INT_MAX;
+    int bestWidth = INT_MAX;
+    int bestY = 0;
+
+    for (size_t i = 0; i < skyline.size(); i++)
+    {
+        const int y = fit(i, width, height);
+        if (y < 0) continue;
+
+        if (y + height < bestBottom || (y + height == bestBottom && skyline[i].width < bestWidth))
+        {
+            bestIndex = static_cast<int>(i);
+            bestBottom = y + height;
+            bestWidth = skyline[i].width;
+            bestY = y;
+        }
+    }
+
+    if (bestIndex < 0) return false;
+
+    const SkylineNode node = {skyline[bestIndex].x, bestY + height, width};
+    skyline.insert(skyline.begin() + bestIndex, node);
+
+    for (size_t i = bestIndex + 1; i < skyline.size(); i++)
+    {
+        const int shrink = skyline[i - 1].x + skyline[i - 1].width - skyline[i].x;
+        if (shrink <= 0) break;
+
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+
+        if (skyline[i].width > 0) break;
+
+        skyline.erase(skyline.begin() + i);
+        i--;
+    }
+
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    rect.x = node.x;
+    rect.y = bestY;
+    rect.w = surface->w;
+    rect.h = surface->h;
+
+    SDL_UpdateTexture(texture, &rect, surface->pixels, surface->pitch);
+    usedArea += static_cast<long>(surface->w) * surface->h;
+
+    return true;
+}
+
+void TextureAtlas::release(const SDL_Rect& rect)
+{
+    if (texture == nullptr) return;
+
+    // Cleared so a smaller image placed here later doesn't have the old pixels as its padding.
+    const SDL_Rect paddedRect = {rect.x, rect.y, std::min(rect.w + padding, size - rect.x), std::min(rect.h + padding, size - rect.y)};
+    const std::vector<uint32_t> emptyPixels(static_cast<size_t>(paddedRect.w) * paddedRect.h, 0);
+    SDL_UpdateTexture(texture, &paddedRect, emptyPixels.data(), paddedRect.w * 4);
+
+    freeRects.push_back(paddedRect);
+    usedArea -= static_cast<long>(rect.w) * rect.h;
+}
+
+SDL_Texture* TextureAtlas::getTexture() const
+{
+    return texture;
+}
+
+float TextureAtlas::getOccupancy() const
+{
+    return static_cast<float>(usedArea) / (static_cast<float>(size) * size);
+}
+
+size_t TextureAtlas::getMemory() const
+{
+    return texture == nullptr ? 0 : static_cast<size_t>(size) * size * 4;
+}
+
+void TextureAtlas::destroy()
+{
+    SDL_DestroyTexture(texture);
+    texture = nullptr;
+    skyline.clear();
+    freeRects.clear();
+    usedArea = 0;
+}
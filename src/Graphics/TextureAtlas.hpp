@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+class TextureAtlas
+{
+public:
+    TextureAtlas(SDL_Renderer* renderer, int size);
+    bool insert(SDL_Surface* surface, SDL_Rect& rect);
+    void release(const SDL_Rect& rect);
+    SDL_Texture* getTexture() const;
+    float getOccupancy() const;
+    size_t getMemory() const;
+    void destroy();
+
+private:
+    struct SkylineNode
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    int size;
+    long usedArea = 0;
+    SDL_Texture* texture = nullptr;
+    std::vector<SkylineNode> skyline;
+    // Released space, reused before the skyline grows.
+    std::vector<SDL_Rect> freeRects;
+    int fit(size_t index, int width, int height) const;
+    bool insertFree(int width, int height, SDL_Rect& rect);
+};
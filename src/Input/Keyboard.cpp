@@ -100,4 +100,9 @@ bool Keyboard::isKeyDown(Key key)
 bool Keyboard::isKeyPressed(Key key)
 {
     return keysPressed[static_cast<int>(key)] && !keysPressedOld[static_cast<int>(key)];
+}
+
+void Keyboard::setKeyDown(Key key, const bool down)
+{
+    keysPressed[static_cast<int>(key)] = down;
 }
\ No newline at end of file
@@ -38,4 +38,12 @@ namespace Keyboard
      * @return true if the is pressed but wasn't pressed in the previous frame.
      */
     bool isKeyPressed(Key key);
+
+    /**
+     * @brief Set the state of a key as if it was pressed or released, e.g. to drive the game from automated tests in headless mode.
+     * 
+     * @param key the key to set
+     * @param down true if the key is pressed, false if it is released
+     */
+    void setKeyDown(Key key, bool down);
 }
\ No newline at end of file
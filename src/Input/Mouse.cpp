@@ -96,6 +96,16 @@ void Mouse::createCustomCursor(const std::string& path, const int hotX, const in
     SDL_FreeSurface(surface);
 }
 
+void Mouse::setButtonDown(MouseButton button, const bool down)
+{
+    buttonsPressed[static_cast<int>(button)] = down;
+}
+
+void Mouse::setMouseScreenPosition(const Vector2i& position)
+{
+    mousePositon = position;
+}
+
 void Mouse::cleanUp()
 {
     SDL_FreeCursor(cursor);
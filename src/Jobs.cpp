@@ -0,0 +1,308 @@
+#include "Jobs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+struct Job
+{
+    std::function<void()> task;
+    // One extra count is held while the dependencies are registered, so the job can't start early.
+    std::atomic<int> pendingDependencies = 1;
+    std::atomic<bool> finished = false;
+    std::mutex mutex;
+    std::vector<JobHandle> dependents;
+};
+
+// Every worker has its own queue, so workers rarely contend for the same lock.
+struct WorkerQueue
+{
+    std::mutex mutex;
+    std::deque<JobHandle> jobs;
+};
+
+static unsigned int workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+static std::vector<std::thread> workers;
+static std::vector<std::unique_ptr<WorkerQueue>> queues;
+static std::mutex startMutex;
+static std::atomic<bool> started = false;
+static std::atomic<size_t> queuedJobs = 0;
+static std::atomic<unsigned int> nextQueue = 0;
+static std::atomic<unsigned int> waitingThreads = 0;
+static std::mutex sleepMutex;
+static std::condition_variable sleepCondition;
+static bool stopping = false;
+static thread_local int workerIndex = -1;
+
+static void execute(const JobHandle& job);
+
+static void schedule(JobHandle job)
+{
+    if (queues.empty())
+    {
+        execute(job);
+        return;
+    }
+
+    // Workers queue follow-up jobs for themselves, other threads spread their jobs over all workers.
+    const size_t index = workerIndex >= 0 ? workerIndex : nextQueue++ % queues.size();
+
+    // Counted before the job is queued, so the count can't drop below the number of queued jobs.
+    queuedJobs++;
+    {
+        std::lock_guard lock(queues[index]->mutex);
+        queues[index]->jobs.push_back(std::move(job));
+    }
+
+    {
+        std::lock_guard lock(sleepMutex);
+    }
+    sleepCondition.notify_one();
+}
+
+static void release(JobHandle job)
+{
+    if (--job->pendingDependencies == 0)
+    {
+        schedule(std::move(job));
+    }
+}
+
+static JobHandle popJob()
+{
+    if (queuedJobs == 0) return nullptr;
+
+    const size_t count = queues.size();
+    const size_t first = workerIndex >= 0 ? workerIndex : 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        WorkerQueue& queue = *queues[(first + i) % count];
+        std::lock_guard lock(queue.mutex);
+        if (queue.jobs.empty()) continue;
+
+        // A worker takes its newest job, which is likely still in the cache. Others steal the oldest one.
+        JobHandle job;
+        if (i == 0 && workerIndex >= 0)
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        }
+        else
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+        queuedJobs--;
+        return job;
+    }
+    return nullptr;
+}
+
+static void execute(const JobHandle& job)
+{
+    job->task();
+    job->task = nullptr;
+
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard lock(job->mutex);
+        job->finished = true;
+        dependents.swap(job->dependents);
+    }
+
+    for (JobHandle& dependent : dependents)
+    {
+        release(std::move(dependent));
+    }
+
+    if (waitingThreads > 0)
+    {
+        std::lock_guard lock(sleepMutex);
+        sleepCondition.notify_all();
+    }
+}
+
+static void work(const int index)
+{
+    workerIndex = index;
+
+    while (true)
+    {
+        if (const JobHandle job = popJob())
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock lock(sleepMutex);
+        sleepCondition.wait(lock, [] { return stopping || queuedJobs > 0; });
+
+        if (stopping) return;
+    }
+}
+
+static void start()
+{
+    std::lock_guard lock(startMutex);
+    if (started) return;
+
+    stopping = false;
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(work, static_cast<int>(i));
+    }
+    started = true;
+}
+
+void Jobs::shutdown()
+{
+    std::lock_guard startLock(startMutex);
+    if (!started) return;
+
+    {
+        std::lock_guard lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCondition.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+
+    // Workers only stop once the queues are empty, but jobs queued while they were stopping are dropped. They count as finished, so nothing waits for them forever.
+    std::vector<JobHandle> droppedJobs;
+    for (const std::unique_ptr<WorkerQueue>& queue : queues)
+    {
+        droppedJobs.insert(droppedJobs.end(), queue->jobs.begin(), queue->jobs.end());
+    }
+    while (!droppedJobs.empty())
+    {
+        const JobHandle job = std::move(droppedJobs.back());
+        droppedJobs.pop_back();
+
+        std::lock_guard lock(job->mutex);
+        job->task = nullptr;
+        job->finished = true;
+        droppedJobs.insert(droppedJobs.end(), job->dependents.begin(), job->dependents.end());
+        job->dependents.clear();
+    }
+    {
+        std::lock_guard lock(sleepMutex);
+        sleepCondition.notify_all();
+    }
+
+    queues.clear();
+    queuedJobs = 0;
+    started = false;
+}
+
+JobHandle Jobs::run(const std::function<void()>& task, const std::vector<JobHandle>& dependencies)
+{
+    if (!started) start();
+
+    JobHandle job = std::make_shared<Job>();
+    job->task = task;
+
+    for (const JobHandle& dependency : dependencies)
+    {
+        if (!dependency) continue;
+
+        std::lock_guard lock(dependency->mutex);
+        if (dependency->finished) continue;
+
+        job->pendingDependencies++;
+        dependency->dependents.push_back(job);
+    }
+
+    release(job);
+    return job;
+}
+
+void Jobs::wait(const JobHandle& job)
+{
+    if (!job) return;
+
+    while (!job->finished)
+    {
+        // Helping out keeps waiting threads busy and can't deadlock when jobs wait for other jobs.
+        if (const JobHandle other = popJob())
+        {
+            execute(other);
+            continue;
+        }
+
+        waitingThreads++;
+        {
+            std::unique_lock lock(sleepMutex);
+            sleepCondition.wait(lock, [&job] { return job->finished || queuedJobs > 0; });
+        }
+        waitingThreads--;
+    }
+}
+
+bool Jobs::isFinished(const JobHandle& job)
+{
+    return !job || job->finished;
+}
+
+void Jobs::parallelFor(const size_t count, const std::function<void(size_t begin, size_t end)>& function, const size_t grainSize)
+{
+    if (count == 0) return;
+    if (!started) start();
+
+    // A few ranges per thread even out uneven work without making the ranges too small.
+    const size_t rangesWanted = (queues.size() + 1) * 4;
+    const size_t rangeSize = std::max({grainSize, static_cast<size_t>(1), (count + rangesWanted - 1) / rangesWanted});
+    const size_t rangeCount = (count + rangeSize - 1) / rangeSize;
+
+    if (rangeCount == 1 || queues.empty())
+    {
+        function(0, count);
+        return;
+    }
+
+    // Ranges are handed out on demand, so a thread that finishes early takes over the remaining ones.
+    std::atomic<size_t> nextRange = 0;
+    const auto runRanges = [&] {
+        for (size_t range = nextRange++; range < rangeCount; range = nextRange++)
+        {
+            const size_t begin = range * rangeSize;
+            function(begin, std::min(begin + rangeSize, count));
+        }
+    };
+
+    std::vector<JobHandle> helpers;
+    const size_t helperCount = std::min(queues.size(), rangeCount - 1);
+    for (size_t i = 0; i < helperCount; i++)
+    {
+        helpers.push_back(run(runRanges));
+    }
+
+    runRanges();
+
+    for (const JobHandle& helper : helpers)
+    {
+        wait(helper);
+    }
+}
+
+unsigned int Jobs::getWorkerCount()
+{
+    return workerCount;
+}
+
+void Jobs::setWorkerCount(const unsigned int count)
+{
+    std::lock_guard lock(startMutex);
+    if (!started) workerCount = count;
+}
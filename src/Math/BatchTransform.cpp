@@ -0,0 +1,87 @@
+#include "BatchTransform.hpp"
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BEE_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BEE_NEON
+#endif
+
+void BatchTransform::transform(const float* x, const float* y, float* outX, float* outY, const size_t count, const Vector2f& offset, const Vector2f& scale)
+{
+    size_t i = 0;
+
+#if defined(BEE_SSE)
+    const __m128 offsetX = _mm_set1_ps(offset.x);
+    const __m128 offsetY = _mm_set1_ps(offset.y);
+    const __m128 scaleX = _mm_set1_ps(scale.x);
+    const __m128 scaleY = _mm_set1_ps(scale.y);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(outX + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(x + i), offsetX), scaleX));
+        _mm_storeu_ps(outY + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(y + i), offsetY), scaleY));
+    }
+#elif defined(BEE_NEON)
+    const float32x4_t offsetX = vdupq_n_f32(offset.x);
+    const float32x4_t offsetY = vdupq_n_f32(offset.y);
+    const float32x4_t scaleX = vdupq_n_f32(scale.x);
+    const float32x4_t scaleY = vdupq_n_f32(scale.y);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(outX + i, vmulq_f32(vaddq_f32(vld1q_f32(x + i), offsetX), scaleX));
+        vst1q_f32(outY + i, vmulq_f32(vaddq_f32(vld1q_f32(y + i), offsetY), scaleY));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        outX[i] = (x[i] + offset.x) * scale.x;
+        outY[i] = (y[i] + offset.y) * scale.y;
+    }
+}
+
+void BatchTransform::rotate(const float* x, const float* y, float* outX, float* outY, const size_t count, const Vector2f& center, const float rotation)
+{
+    const float cosine = cosf(rotation * M_PI / 180.0f);
+    const float sine = sinf(rotation * M_PI / 180.0f);
+    size_t i = 0;
+
+#if defined(BEE_SSE)
+    const __m128 centerX = _mm_set1_ps(center.x);
+    const __m128 centerY = _mm_set1_ps(center.y);
+    const __m128 cosines = _mm_set1_ps(cosine);
+    const __m128 sines = _mm_set1_ps(sine);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 relativeX = _mm_sub_ps(_mm_loadu_ps(x + i), centerX);
+        const __m128 relativeY = _mm_sub_ps(_mm_loadu_ps(y + i), centerY);
+        _mm_storeu_ps(outX + i, _mm_add_ps(centerX, _mm_sub_ps(_mm_mul_ps(relativeX, cosines), _mm_mul_ps(relativeY, sines))));
+        _mm_storeu_ps(outY + i, _mm_add_ps(centerY, _mm_add_ps(_mm_mul_ps(relativeX, sines), _mm_mul_ps(relativeY, cosines))));
+    }
+#elif defined(BEE_NEON)
+    const float32x4_t centerX = vdupq_n_f32(center.x);
+    const float32x4_t centerY = vdupq_n_f32(center.y);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const float32x4_t relativeX = vsubq_f32(vld1q_f32(x + i), centerX);
+        const float32x4_t relativeY = vsubq_f32(vld1q_f32(y + i), centerY);
+        vst1q_f32(outX + i, vaddq_f32(centerX, vsubq_f32(vmulq_n_f32(relativeX, cosine), vmulq_n_f32(relativeY, sine))));
+        vst1q_f32(outY + i, vaddq_f32(centerY, vaddq_f32(vmulq_n_f32(relativeX, sine), vmulq_n_f32(relativeY, cosine))));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        const float relativeX = x[i] - center.x;
+        const float relativeY = y[i] - center.y;
+        outX[i] = center.x + relativeX * cosine - relativeY * sine;
+        outY[i] = center.y + relativeX * sine + relativeY * cosine;
+    }
+}
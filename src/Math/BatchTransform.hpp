@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Math/Vector2f.hpp"
+
+/**
+ * @namespace BatchTransform
+ * 
+ * @brief Transforms for arrays of positions stored as separate x and y arrays.
+ * 
+ */
+namespace BatchTransform
+{
+    /**
+     * @brief Calculate (position + offset) * scale for every position. The output arrays may be the input arrays.
+     * 
+     * @param x the x coordinates
+     * @param y the y coordinates
+     * @param outX the transformed x coordinates
+     * @param outY the transformed y coordinates
+     * @param count the number of positions
+     * @param offset the offset added before scaling
+     * @param scale the scale applied after the offset
+     */
+    void transform(const float* x, const float* y, float* outX, float* outY, size_t count, const Vector2f& offset, const Vector2f& scale);
+
+    /**
+     * @brief Rotate every position around a center point.
+     * 
+     * @param x the x coordinates
+     * @param y the y coordinates
+     * @param outX the rotated x coordinates
+     * @param outY the rotated y coordinates
+     * @param count the number of positions
+     * @param center the point to rotate around
+     * @param rotation the rotation in degrees
+     */
+    void rotate(const float* x, const float* y, float* outX, float* outY, size_t count, const Vector2f& center, float rotation);
+}
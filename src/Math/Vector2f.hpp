@@ -1,24 +1,94 @@
 #pragma once
 
+#include <cmath>
+
 struct Vector2f
 {
     float x;
     float y;
 
-    Vector2f();
-    Vector2f(float x, float y);
-    float dot(const Vector2f& right) const;
-    float getLength() const;
-    void normalize();
-    void operator+=(const Vector2f& other);
-    void operator-=(const Vector2f& other);
-    void operator*=(float multiplier);
-    void operator*=(const Vector2f& other);
-    void operator/=(const Vector2f& other);
-    bool operator==(const Vector2f& other) const;
-    Vector2f operator+(const Vector2f& other) const;
-    Vector2f operator-(const Vector2f& other) const;
-    Vector2f operator*(float multiplier) const;
-    Vector2f operator*(const Vector2f& other) const;
-    Vector2f operator/(float divider) const;
-};
\ No newline at end of file
+    constexpr Vector2f()
+        : x(0), y(0) {}
+
+    constexpr Vector2f(const float x, const float y)
+        : x(x), y(y) {}
+
+    constexpr float dot(const Vector2f& right) const
+    {
+        return x * right.x + y * right.y;
+    }
+
+    float getLength() const
+    {
+        return sqrtf(x * x + y * y);
+    }
+
+    void normalize()
+    {
+        const float length = getLength();
+        if (length <= 0) return;
+        const float scale = 1.0f / length;
+        x *= scale;
+        y *= scale;
+    }
+
+    constexpr void operator+=(const Vector2f& other)
+    {
+        x += other.x;
+        y += other.y;
+    }
+
+    constexpr void operator-=(const Vector2f& other)
+    {
+        x -= other.x;
+        y -= other.y;
+    }
+
+    constexpr void operator*=(const float multiplier)
+    {
+        x *= multiplier;
+        y *= multiplier;
+    }
+
+    constexpr void operator*=(const Vector2f& other)
+    {
+        x *= other.x;
+        y *= other.y;
+    }
+
+    constexpr void operator/=(const Vector2f& other)
+    {
+        x /= other.x;
+        y /= other.y;
+    }
+
+    constexpr bool operator==(const Vector2f& other) const
+    {
+        return x == other.x && y == other.y;
+    }
+
+    constexpr Vector2f operator+(const Vector2f& other) const
+    {
+        return {x + other.x, y + other.y};
+    }
+
+    constexpr Vector2f operator-(const Vector2f& other) const
+    {
+        return {x - other.x, y - other.y};
+    }
+
+    constexpr Vector2f operator*(const float multiplier) const
+    {
+        return {x * multiplier, y * multiplier};
+    }
+
+    constexpr Vector2f operator*(const Vector2f& other) const
+    {
+        return {x * other.x, y * other.y};
+    }
+
+    constexpr Vector2f operator/(const float divider) const
+    {
+        return {x / divider, y / divider};
+    }
+};
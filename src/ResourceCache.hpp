@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+template <typename Key, typename Resource, typename Hash = std::hash<Key>>
+class ResourceCache
+{
+public:
+    using UnloadFunction = std::function<void(const Key&, Resource)>;
+    using InUseFunction = std::function<bool(Resource)>;
+
+    explicit ResourceCache(UnloadFunction unload, InUseFunction inUse = nullptr)
+        : unload(std::move(unload)), inUse(std::move(inUse))
+    {
+    }
+
+    bool contains(const Key& key) const
+    {
+        return entries.contains(key);
+    }
+
+    Resource* find(const Key& key)
+    {
+        const auto iterator = entries.find(key);
+        if (iterator == entries.end()) return nullptr;
+
+        lru.splice(lru.begin(), lru, iterator->second.lruPosition);
+        return &iterator->second.resource;
+    }
+
+    void insert(const Key& key, Resource resource, const size_t bytes, const int references = 0)
+    {
+        lru.push_front(key);
+        entries.insert({key, {resource, bytes, references, lru.begin()}});
+        residentBytes += bytes;
+        trim();
+    }
+
+    void retain(const Key& key)
+    {
+        if (const auto iterator = entries.find(key); iterator != entries.end())
+            iterator->second.references++;
+    }
+
+    void release(const Key& key)
+    {
+        const auto iterator = entries.find(key);
+        if (iterator == entries.end() || iterator->second.references == 0) return;
+
+        iterator->second.references--;
+        trim();
+    }
+
+    // Unloads the least recently used unreferenced resources until the cache fits into its budget.
+    // The most recently used resource is always kept, so a resource that was just loaded can be used.
+    void trim()
+    {
+        for (auto iterator = lru.end(); residentBytes > budget && iterator != lru.begin();)
+        {
+            if (--iterator == lru.begin()) break;
+
+            const auto entry = entries.find(*iterator);
+            if (entry->second.references > 0 || (inUse && inUse(entry->second.resource))) continue;
+
+            residentBytes -= entry->second.bytes;
+            unload(entry->first, entry->second.resource);
+            entries.erase(entry);
+            iterator = lru.erase(iterator);
+        }
+    }
+
+    void clear()
+    {
+        for (const auto& [key, entry] : entries)
+        {
+            unload(key, entry.resource);
+        }
+        entries.clear();
+        lru.clear();
+        residentBytes = 0;
+    }
+
+    void setBudget(const size_t bytes)
+    {
+        budget = bytes;
+        trim();
+    }
+
+    size_t getResidentBytes() const
+    {
+        return residentBytes;
+    }
+
+private:
+    struct Entry
+    {
+        Resource resource;
+        size_t bytes;
+        int references;
+        typename std::list<Key>::iterator lruPosition;
+    };
+
+    std::unordered_map<Key, Entry, Hash> entries;
+    // Most recently used keys are at the front.
+    std::list<Key> lru;
+    size_t residentBytes = 0;
+    size_t budget = SIZE_MAX;
+    UnloadFunction unload;
+    InUseFunction inUse;
+};
@@ -0,0 +1,107 @@
+#include "HUDGrid.hpp"
+
+#include <algorithm>
+#include <climits>
+
+#include "Graphics/HUDObject.hpp"
+
+static constexpr int maxCellsPerAxis = 128;
+
+void HUDGrid::invalidate()
+{
+    dirty = true;
+}
+
+void HUDGrid::build(const std::vector<HUDObject*>& hudObjects)
+{
+    dirty = false;
+    transformVersion = HUDObject::getTransformVersion();
+    entries.clear();
+
+    Vector2i min(INT_MAX, INT_MAX);
+    Vector2i max(INT_MIN, INT_MIN);
+
+    for (HUDObject* hudObject : hudObjects)
+    {
+        Entry entry;
+        entry.hudObject = hudObject;
+        hudObject->getBounds(entry.min, entry.max);
+        entries.push_back(entry);
+
+        min.x = std::min(min.x, entry.min.x);
+        min.y = std::min(min.y, entry.min.y);
+        max.x = std::max(max.x, entry.max.x);
+        max.y = std::max(max.y, entry.max.y);
+    }
+
+    for (std::vector<uint32_t>& cell : cells)
+    {
+        cell.clear();
+    }
+
+    if (entries.empty())
+    {
+        columns = 0;
+        rows = 0;
+        return;
+    }
+
+    // Grow the cells for huge layouts so the grid stays small.
+    cellSize = std::max({64, (max.x - min.x) / maxCellsPerAxis + 1, (max.y - min.y) / maxCellsPerAxis + 1});
+    origin = min;
+    columns = (max.x - min.x) / cellSize + 1;
+    rows = (max.y - min.y) / cellSize + 1;
+    cells.resize(std::max(cells.size(), static_cast<size_t>(columns * rows)));
+
+    for (uint32_t i = 0; i < entries.size(); i++)
+    {
+        const int startX = (entries[i].min.x - origin.x) / cellSize;
+        const int endX = (entries[i].max.x - origin.x) / cellSize;
+        const int startY = (entries[i].min.y - origin.y) / cellSize;
+        const int endY = (entries[i].max.y - origin.y) / cellSize;
+
+        for (int y = startY; y <= endY; y++)
+        {
+            for (int x = startX; x <= endX; x++)
+            {
+                cells[x + y * columns].push_back(i);
+            }
+        }
+    }
+}
+
+HUDObject* HUDGrid::find(const std::vector<HUDObject*>& hudObjects, const Vector2i& point)
+{
+    if (dirty || transformVersion != HUDObject::getTransformVersion())
+    {
+        build(hudObjects);
+    }
+    else if (point == lastPoint)
+    {
+        return lastResult;
+    }
+
+    lastPoint = point;
+    lastResult = nullptr;
+
+    const int x = point.x - origin.x;
+    const int y = point.y - origin.y;
+    if (x < 0 || y < 0 || x / cellSize >= columns || y / cellSize >= rows) return nullptr;
+
+    // HUD objects are drawn in order, so the one with the highest index is on top.
+    const std::vector<uint32_t>& cell = cells[x / cellSize + y / cellSize * columns];
+    for (auto index = cell.rbegin(); index != cell.rend(); ++index)
+    {
+        const Entry& entry = entries[*index];
+        if (point.x < entry.min.x || point.x > entry.max.x || point.y < entry.min.y || point.y > entry.max.y)
+            continue;
+
+        if (entry.hudObject->containsPoint(point))
+        {
+            lastResult = entry.hudObject;
+            break;
+        }
+    }
+
+    return lastResult;
+}
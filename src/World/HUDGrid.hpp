@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Vector2i.hpp"
+
+class HUDObject;
+
+class HUDGrid
+{
+public:
+    void invalidate();
+    HUDObject* find(const std::vector<HUDObject*>& hudObjects, const Vector2i& point);
+
+private:
+    struct Entry
+    {
+        HUDObject* hudObject;
+        Vector2i min;
+        Vector2i max;
+    };
+
+    bool dirty = true;
+    int cellSize = 64;
+    int columns = 0;
+    int rows = 0;
+    uint64_t transformVersion = 0;
+    Vector2i origin;
+    Vector2i lastPoint;
+    HUDObject* lastResult = nullptr;
+    std::vector<Entry> entries;
+    std::vector<std::vector<uint32_t>> cells;
+    void build(const std::vector<HUDObject*>& hudObjects);
+};
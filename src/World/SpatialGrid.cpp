@@ -0,0 +1,330 @@
+#include "SpatialGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Entity.hpp"
+#include "Collision/Collision.hpp"
+
+static uint64_t getCellKey(const int x, const int y)
+{
+    return static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(y);
+}
+
+void SpatialGrid::setCellSize(const float cellSize)
+{
+    this->cellSize = cellSize;
+    cells.clear();
+    dirty = true;
+}
+
+void SpatialGrid::invalidate()
+{
+    dirty = true;
+}
+
+void SpatialGrid::markMoved(const uint32_t index)
+{
+    // A full rebuild is coming anyway, and the index may belong to another entity by then.
+    if (dirty || index >= entries.size() || entries[index].moved) return;
+
+    // Entities moving in parallel only touch their own entry, the flags are collected when the grid is unfrozen.
+    entries[index].moved = true;
+    if (!frozen) movedEntries.push_back(index);
+}
+
+int SpatialGrid::getCell(const float coordinate) const
+{
+    return static_cast<int>(floorf(coordinate / cellSize));
+}
+
+const std::vector<uint32_t>* SpatialGrid::findCell(const int x, const int y) const
+{
+    const auto cell = cells.find(getCellKey(x, y));
+    if (cell == cells.end() || cell->second.empty()) return nullptr;
+    return &cell->second;
+}
+
+void SpatialGrid::updateEntry(Entry& entry)
+{
+    entry.position = entry.entity->getPosition();
+    entry.hitbox = entry.entity->getHitBox();
+    Collision::getBounds(entry.hitbox, entry.min, entry.max);
+
+    entry.startX = getCell(entry.min.x);
+    entry.endX = getCell(entry.max.x);
+    entry.startY = getCell(entry.min.y);
+    entry.endY = getCell(entry.max.y);
+}
+
+void SpatialGrid::insertEntry(const uint32_t index)
+{
+    const Entry& entry = entries[index];
+    for (int y = entry.startY; y <= entry.endY; y++)
+    {
+        for (int x = entry.startX; x <= entry.endX; x++)
+        {
+            cells[getCellKey(x, y)].push_back(index);
+        }
+    }
+
+    minCellX = std::min(minCellX, entry.startX);
+    minCellY = std::min(minCellY, entry.startY);
+    maxCellX = std::max(maxCellX, entry.endX);
+    maxCellY = std::max(maxCellY, entry.endY);
+}
+
+void SpatialGrid::removeEntry(const uint32_t index, const int startX, const int startY, const int endX, const int endY)
+{
+    for (int y = startY; y <= endY; y++)
+    {
+        for (int x = startX; x <= endX; x++)
+        {
+            std::vector<uint32_t>& cell = cells[getCellKey(x, y)];
+            const auto position = std::find(cell.begin(), cell.end(), index);
+            if (position == cell.end()) continue;
+
+            *position = cell.back();
+            cell.pop_back();
+        }
+    }
+}
+
+void SpatialGrid::rebuild(const std::vector<Entity*>& entities)
+{
+    dirty = false;
+    movedEntries.clear();
+
+    // Keep the cell vectors around so rebuilding doesn't reallocate.
+    if (cells.size() > entities.size() * 4 + 64)
+    {
+        cells.clear();
+    }
+    for (auto& [key, cell] : cells)
+    {
+        cell.clear();
+    }
+    entries.resize(entities.size());
+
+    minCellX = INT32_MAX;
+    minCellY = INT32_MAX;
+    maxCellX = INT32_MIN;
+    maxCellY = INT32_MIN;
+
+    for (uint32_t index = 0; index < entities.size(); index++)
+    {
+        Entry& entry = entries[index];
+        entry.entity = entities[index];
+        entry.moved = false;
+        updateEntry(entry);
+        insertEntry(index);
+
+        // From now on the entity reports its own moves, so only moved entities have to be updated.
+        entry.entity->setSpatialGrid(this, index);
+    }
+}
+
+void SpatialGrid::update(const std::vector<Entity*>& entities)
+{
+    if (frozen) return;
+
+    if (dirty)
+    {
+        rebuild(entities);
+        buildCount++;
+        return;
+    }
+
+    if (movedEntries.empty()) return;
+
+    for (const uint32_t index : movedEntries)
+    {
+        Entry& entry = entries[index];
+        entry.moved = false;
+
+        const int startX = entry.startX;
+        const int startY = entry.startY;
+        const int endX = entry.endX;
+        const int endY = entry.endY;
+        updateEntry(entry);
+
+        // Most moves stay inside the same cells.
+        if (entry.startX == startX && entry.startY == startY && entry.endX == endX && entry.endY == endY) continue;
+
+        removeEntry(index, startX, startY, endX, endY);
+        insertEntry(index);
+    }
+    movedEntries.clear();
+    buildCount++;
+}
+
+void SpatialGrid::freeze(const std::vector<Entity*>& entities)
+{
+    update(entities);
+    frozen = true;
+}
+
+void SpatialGrid::unfreeze()
+{
+    frozen = false;
+    if (dirty) return;
+
+    for (uint32_t index = 0; index < entries.size(); index++)
+    {
+        if (entries[index].moved) movedEntries.push_back(index);
+    }
+}
+
+// Entries spanning several cells are only looked at in their first cell inside the queried range, so queries don't need to mark visited entries.
+void SpatialGrid::queryRectangle(const Vector2f& min, const Vector2f& max, std::vector<Entity*>& result) const
+{
+    const int startX = std::max(getCell(min.x), minCellX);
+    const int endX = std::min(getCell(max.x), maxCellX);
+    const int startY = std::max(getCell(min.y), minCellY);
+    const int endY = std::min(getCell(max.y), maxCellY);
+
+    for (int y = startY; y <= endY; y++)
+    {
+        for (int x = startX; x <= endX; x++)
+        {
+            const std::vector<uint32_t>* cell = findCell(x, y);
+            if (!cell) continue;
+
+            for (const uint32_t index : *cell)
+            {
+                const Entry& entry = entries[index];
+                if (x != std::max(startX, entry.startX) || y != std::max(startY, entry.startY)) continue;
+
+                if (entry.max.x < min.x || entry.min.x > max.x || entry.max.y < min.y || entry.min.y > max.y)
+                    continue;
+
+                result.push_back(entry.entity);
+            }
+        }
+    }
+}
+
+void SpatialGrid::queryRadius(const Vector2f& center, const float radius, std::vector<Entity*>& result) const
+{
+    const float radiusSquared = radius * radius;
+    const int startX = std::max(getCell(center.x - radius), minCellX);
+    const int endX = std::min(getCell(center.x + radius), maxCellX);
+    const int startY = std::max(getCell(center.y - radius), minCellY);
+    const int endY = std::min(getCell(center.y + radius), maxCellY);
+
+    for (int y = startY; y <= endY; y++)
+    {
+        for (int x = startX; x <= endX; x++)
+        {
+            const std::vector<uint32_t>* cell = findCell(x, y);
+            if (!cell) continue;
+
+            for (const uint32_t index : *cell)
+            {
+                const Entry& entry = entries[index];
+                if (x != std::max(startX, entry.startX) || y != std::max(startY, entry.startY)) continue;
+
+                const Vector2f difference = entry.position - center;
+                if (difference.dot(difference) <= radiusSquared)
+                {
+                    result.push_back(entry.entity);
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::queryNearest(const Vector2f& position, const size_t count, std::vector<Entity*>& result, const std::function<bool(const Entity*)>& filter) const
+{
+    if (count == 0 || entries.empty()) return;
+
+    std::vector<std::pair<float, uint32_t>> candidates;
+    const int centerX = getCell(position.x);
+    const int centerY = getCell(position.y);
+    const int maxRing = std::max({centerX - minCellX, maxCellX - centerX, centerY - minCellY, maxCellY - centerY});
+
+    for (int ring = 0; ring <= maxRing; ring++)
+    {
+        for (int y = centerY - ring; y <= centerY + ring; y++)
+        {
+            // Only the border of the ring is new, the inside was visited by the previous rings.
+            const int step = y == centerY - ring || y == centerY + ring ? 1 : std::max(1, ring * 2);
+
+            for (int x = centerX - ring; x <= centerX + ring; x += step)
+            {
+                const std::vector<uint32_t>* cell = findCell(x, y);
+                if (!cell) continue;
+
+                for (const uint32_t index : *cell)
+                {
+                    // An entry is first reached through its cell closest to the center.
+                    const Entry& entry = entries[index];
+                    if (x != std::clamp(centerX, entry.startX, entry.endX) || y != std::clamp(centerY, entry.startY, entry.endY)) continue;
+
+                    if (filter && !filter(entry.entity)) continue;
+
+                    const Vector2f difference = entry.position - position;
+                    candidates.emplace_back(difference.dot(difference), index);
+                }
+            }
+        }
+
+        // Anything outside of the visited rings is at least this far away.
+        if (candidates.size() >= count)
+        {
+            std::nth_element(candidates.begin(), candidates.begin() + count - 1, candidates.end());
+            const float searchedDistance = ring * cellSize;
+            if (candidates[count - 1].first <= searchedDistance * searchedDistance) break;
+        }
+    }
+
+    const size_t resultCount = std::min(count, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + resultCount, candidates.end());
+
+    for (size_t i = 0; i < resultCount; i++)
+    {
+        result.push_back(entries[candidates[i].second].entity);
+    }
+}
+
+void SpatialGrid::queryPoint(const Vector2f& position, std::vector<Entity*>& result) const
+{
+    const std::vector<uint32_t>* cell = findCell(getCell(position.x), getCell(position.y));
+    if (!cell) return;
+
+    std::vector<uint32_t> hits;
+    Hitbox point;
+    point.vertices.push_back(position);
+
+    for (const uint32_t index : *cell)
+    {
+        const Entry& entry = entries[index];
+        if (position.x < entry.min.x || position.x > entry.max.x || position.y < entry.min.y || position.y > entry.max.y)
+            continue;
+
+        Intersection intersection;
+        if (Collision::checkCollision(entry.hitbox, point, intersection))
+        {
+            hits.push_back(index);
+        }
+    }
+
+    // Entities are drawn in the order they were added, so the last one is on top.
+    std::sort(hits.begin(), hits.end());
+    for (const uint32_t index : hits)
+    {
+        result.push_back(entries[index].entity);
+    }
+}
+
+const std::vector<Entity*>& SpatialGrid::queryPoint(const Vector2f& position)
+{
+    if (pointBuildCount == buildCount && pointPosition == position) return pointResult;
+
+    pointBuildCount = buildCount;
+    pointPosition = position;
+    pointResult.clear();
+    queryPoint(position, pointResult);
+
+    return pointResult;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "Collision/Hitbox.hpp"
+#include "Math/Vector2f.hpp"
+
+class Entity;
+
+class SpatialGrid
+{
+public:
+    void setCellSize(float cellSize);
+    void invalidate();
+    void markMoved(uint32_t index);
+    void update(const std::vector<Entity*>& entities);
+    void freeze(const std::vector<Entity*>& entities);
+    void unfreeze();
+    void queryRectangle(const Vector2f& min, const Vector2f& max, std::vector<Entity*>& result) const;
+    void queryRadius(const Vector2f& center, float radius, std::vector<Entity*>& result) const;
+    void queryNearest(const Vector2f& position, size_t count, std::vector<Entity*>& result, const std::function<bool(const Entity*)>& filter) const;
+    void queryPoint(const Vector2f& position, std::vector<Entity*>& result) const;
+    const std::vector<Entity*>& queryPoint(const Vector2f& position);
+
+private:
+    struct Entry
+    {
+        Entity* entity;
+        Vector2f position;
+        Vector2f min;
+        Vector2f max;
+        Hitbox hitbox;
+        int startX;
+        int startY;
+        int endX;
+        int endY;
+        bool moved;
+    };
+
+    bool dirty = true;
+    bool frozen = false;
+    float cellSize = 4.0f;
+    uint64_t buildCount = 0;
+    int minCellX = 0;
+    int minCellY = 0;
+    int maxCellX = 0;
+    int maxCellY = 0;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> movedEntries;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    uint64_t pointBuildCount = UINT64_MAX;
+    Vector2f pointPosition;
+    std::vector<Entity*> pointResult;
+    int getCell(float coordinate) const;
+    const std::vector<uint32_t>* findCell(int x, int y) const;
+    void rebuild(const std::vector<Entity*>& entities);
+    void updateEntry(Entry& entry);
+    void insertEntry(uint32_t index);
+    void removeEntry(uint32_t index, int startX, int startY, int endX, int endY);
+};
@@ -23,6 +23,7 @@ struct Tile
     bool animated;
     int currentX, currentY;
     int x, y;
+    int textureX, textureY;
     int width, height;
     int columns;
     int tilesetWidth, tilesetHeight;
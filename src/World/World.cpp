@@ -3,24 +3,66 @@
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <tinyxml2.h>
 
+#include "Assets.hpp"
 #include "Bee.hpp"
 #include "Entity.hpp"
+#include "Jobs.hpp"
 #include "Log.hpp"
 #include "Collision/Collision.hpp"
 #include "Collision/Intersection.hpp"
 #include "Graphics/Renderer.hpp"
+#include "Graphics/SpriteSheet.hpp"
+#include "Input/Mouse.hpp"
 
-World::World() = default;
+struct TilesetData
+{
+    std::string textureName;
+    int firstId = 0;
+    std::vector<Tile> tiles;
+};
+
+struct TilemapData
+{
+    bool loaded = false;
+    int width = 0;
+    int height = 0;
+    std::vector<TileLayer> layers;
+    std::vector<TileLayer> foregroundLayers;
+    std::vector<TilesetData> tilesets;
+    std::vector<WorldObject*> worldObjects;
+    // Logged when the tilemap is loaded, the log isn't thread safe.
+    std::vector<std::string> errors;
+};
+
+struct PreparedTilemap
+{
+    std::string name;
+    // Writes tilemap, which may only be read once the job has finished.
+    JobHandle parsing;
+    TilemapData tilemap;
+    bool parsed = false;
+    std::vector<std::string> textureNames;
+};
+
+World::World()
+{
+    hudGrid = new HUDGrid;
+    spatialGrid = new SpatialGrid;
+}
 
 void World::updateInternal()
 {
+    updateAnimations();
+
     for (const TileLayer &layer : layers)
     {
+        Renderer::beginLayer(RenderLayerType::tiles);
         for (int i = 0; i < worldHeight; i++)
         {
             for (int j = 0; j < worldWidth; j++)
@@ -43,29 +85,16 @@ void World::updateInternal()
         }
     }
 
-    for (Tile &tile : tiles)
-    {
-        if (tile.animated && tile.animationFrames[tile.animationIndex].duration + tile.frameStartTime <= Bee::getTime())
-        {
-            tile.frameStartTime = Bee::getTime();
-            tile.animationIndex++;
-            if (tile.animationIndex >= tile.animationFrames.size())
-            {
-                tile.animationIndex = 0;
-            }
-            tile.currentX = tile.animationFrames[tile.animationIndex].tileId % tile.columns * tile.width;
-            tile.currentY = tile.animationFrames[tile.animationIndex].tileId / tile.columns * tile.height;
-        }
-    }
-
-    for (size_t i = 0; i < entities.size(); i++)
+    Renderer::beginLayer(RenderLayerType::sprites);
+    const float interpolationAlpha = Bee::getInterpolationAlpha();
+    for (const Entity* entity : entities)
     {
-        entities[i]->updateInternal();
-        entities[i]->update();
+        entity->updateInternal(interpolationAlpha);
     }
 
     for (const TileLayer &layer : foregroundLayers)
     {
+        Renderer::beginLayer(RenderLayerType::tiles);
         for (int i = 0; i < worldHeight; i++)
         {
             for (int j = 0; j < worldWidth; j++)
@@ -88,10 +117,82 @@ void World::updateInternal()
         }
     }
 
+    Renderer::beginLayer(RenderLayerType::hud);
+    for (HUDObject* hudObject : hudObjects)
+    {
+        hudObject->updateInternal();
+    }
+}
+
+void World::updateAnimations()
+{
+    for (Tile &tile : tiles)
+    {
+        if (tile.animated && tile.animationFrames[tile.animationIndex].duration + tile.frameStartTime <= Bee::getTime())
+        {
+            tile.frameStartTime = Bee::getTime();
+            tile.animationIndex++;
+            if (tile.animationIndex >= tile.animationFrames.size())
+            {
+                tile.animationIndex = 0;
+            }
+            tile.currentX = tile.textureX + tile.animationFrames[tile.animationIndex].tileId % tile.columns * tile.width;
+            tile.currentY = tile.textureY + tile.animationFrames[tile.animationIndex].tileId / tile.columns * tile.height;
+        }
+    }
+
+    for (const Entity* entity : entities)
+    {
+        entity->updateAnimation();
+    }
+
+    for (const HUDObject* hudObject : hudObjects)
+    {
+        hudObject->updateAnimation();
+    }
+}
+
+void World::updateEntities()
+{
+    for (Entity* entity : entities)
+    {
+        entity->savePreviousTransform();
+    }
+
+    // Entities that only touch their own state are updated on all cores first.
+    parallelEntities.clear();
+    for (Entity* entity : entities)
+    {
+        if (entity->isThreadSafe()) parallelEntities.push_back(entity);
+    }
+
+    // The grid is brought up to date once and then left alone, so parallel queries only read it and see the entities where they were at the start of the update.
+    if (!parallelEntities.empty())
+    {
+        spatialGrid->freeze(entities);
+
+        Jobs::parallelFor(parallelEntities.size(), [this](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                parallelEntities[i]->update();
+            }
+        });
+
+        spatialGrid->unfreeze();
+    }
+
+    // Entities added during this loop missed the parallel phase, so they are updated here even if they are thread safe.
+    const size_t parallelCount = entities.size();
+    for (size_t i = 0; i < entities.size(); i++)
+    {
+        if (i < parallelCount && entities[i]->isThreadSafe()) continue;
+
+        entities[i]->update();
+    }
+
     for (size_t i = 0; i < hudObjects.size(); i++)
     {
         hudObjects[i]->update();
-        hudObjects[i]->updateInternal();
     }
 }
 
@@ -103,7 +204,11 @@ void World::addEntity(Entity* entity)
     }
     else
     {
+        // Otherwise the entity would be drawn sliding from where it was constructed to where it is placed after being added.
+        entity->savePreviousTransform();
+        entity->skipInterpolation();
         entities.push_back(entity);
+        spatialGrid->invalidate();
     }
 }
 
@@ -125,9 +230,11 @@ std::vector<Entity*> World::getAllEntities()
 
 Entity* World::removeEntity(Entity* entity)
 {
-    if (!std::count(entities.begin(), entities.end(), entity))
+    if (std::count(entities.begin(), entities.end(), entity))
     {
+        entity->setSpatialGrid(nullptr, 0);
         std::erase(entities, entity);
+        spatialGrid->invalidate();
         return entity;
     }
 
@@ -142,6 +249,7 @@ void World::deleteAllEntities()
     }
 
     entities.clear();
+    spatialGrid->invalidate();
 }
 
 void World::addHUDObject(HUDObject* hudObject)
@@ -153,6 +261,7 @@ void World::addHUDObject(HUDObject* hudObject)
     else
     {
         hudObjects.push_back(hudObject);
+        hudGrid->invalidate();
     }
 }
 
@@ -166,6 +275,7 @@ HUDObject* World::removeHUDObject(HUDObject* hudObject)
     if (std::count(hudObjects.begin(), hudObjects.end(), hudObject))
     {
         std::erase(hudObjects, hudObject);
+        hudGrid->invalidate();
         return hudObject;
     }
 
@@ -180,6 +290,12 @@ void World::deleteAllHUDObjects()
     }
 
     hudObjects.clear();
+    hudGrid->invalidate();
+}
+
+HUDObject* World::getHUDObjectUnderCursor() const
+{
+    return hudGrid->find(hudObjects, Mouse::getMouseScreenPosition());
 }
 
 std::vector<WorldObject*> World::getAllWorldObjects() const
@@ -211,6 +327,10 @@ std::string World::getTileData(const Vector2f& position, const std::string& inde
 std::vector<Intersection> World::getIntersections(const Entity* entity) const
 {
     std::vector<Intersection> intersections;
+    const Hitbox hitbox = entity->getHitBox();
+    Vector2f hitboxMin;
+    Vector2f hitboxMax;
+    Collision::getBounds(hitbox, hitboxMin, hitboxMax);
 
     for (Entity* entityLoop : entities)
     {
@@ -219,7 +339,15 @@ std::vector<Intersection> World::getIntersections(const Entity* entity) const
         Intersection intersection;
         intersection.entity = entityLoop;
         intersection.worldObject = nullptr;
-        if (Collision::checkCollision(entity->getHitBox(), entityLoop->getHitBox(), intersection))
+
+        if ((entity->hasCollisionMask() || entityLoop->hasCollisionMask()) && entity->getRotation() == 0 && entityLoop->getRotation() == 0)
+        {
+            if (entity->checkMaskCollision(entityLoop, intersection))
+            {
+                intersections.push_back(intersection);
+            }
+        }
+        else if (Collision::checkCollision(hitbox, entityLoop->getHitBox(), intersection))
         {
             intersections.push_back(intersection);
         }
@@ -230,7 +358,7 @@ std::vector<Intersection> World::getIntersections(const Entity* entity) const
         Intersection intersection;
         intersection.entity = nullptr;
         intersection.worldObject = worldObject;
-        if (Collision::checkCollision(entity->getHitBox(), worldObject->getHitbox(), intersection))
+        if (worldObject->checkCollision(hitbox, hitboxMin, hitboxMax, intersection))
         {
             intersections.push_back(intersection);
         }
@@ -239,15 +367,58 @@ std::vector<Intersection> World::getIntersections(const Entity* entity) const
     return intersections;
 }
 
-void World::loadTileset(const std::string &source, int firstId)
+void World::getEntitiesInRadius(const Vector2f& center, const float radius, std::vector<Entity*>& result) const
+{
+    spatialGrid->update(entities);
+    spatialGrid->queryRadius(center, radius, result);
+}
+
+void World::getEntitiesInRectangle(const Vector2f& position, const Vector2f& size, std::vector<Entity*>& result) const
+{
+    spatialGrid->update(entities);
+    spatialGrid->queryRectangle(position, position + size, result);
+}
+
+void World::getNearestEntities(const Vector2f& position, const size_t count, std::vector<Entity*>& result, const std::function<bool(const Entity*)>& filter) const
 {
-    const std::string tileSetPath = "./assets/Worlds/" + source;
+    spatialGrid->update(entities);
+    spatialGrid->queryNearest(position, count, result, filter);
+}
+
+const std::vector<Entity*>& World::getEntitiesAtPosition(const Vector2f& position) const
+{
+    spatialGrid->update(entities);
+    return spatialGrid->queryPoint(position);
+}
+
+void World::getEntitiesAtPosition(const Vector2f& position, std::vector<Entity*>& result) const
+{
+    spatialGrid->update(entities);
+    spatialGrid->queryPoint(position, result);
+}
+
+Entity* World::getEntityUnderCursor() const
+{
+    const std::vector<Entity*>& entitiesAtCursor = getEntitiesAtPosition(Mouse::getMouseWorldPosition());
+    return entitiesAtCursor.empty() ? nullptr : entitiesAtCursor.back();
+}
+
+void World::setSpatialCellSize(const float cellSize)
+{
+    spatialGrid->setCellSize(cellSize);
+}
+
+// Parsing doesn't touch the renderer or the log, so a tilemap can be parsed on another thread.
+static void parseTileset(const std::string& source, const int firstId, TilemapData& tilemap)
+{
+    std::string tilesetFile;
+    Assets::readFile("Worlds/" + source, tilesetFile);
 
     tinyxml2::XMLDocument tilesetXML;
-    tilesetXML.LoadFile(tileSetPath.c_str());
+    tilesetXML.Parse(tilesetFile.data(), tilesetFile.size());
     if (tilesetXML.Error())
     {
-        Log::write("World", LogLevel::error, "Can't not load tileset: %s / %s", source.c_str(), tilesetXML.ErrorName());
+        tilemap.errors.push_back("Can't not load tileset: " + source + " / " + tilesetXML.ErrorName());
         return;
     }
 
@@ -259,8 +430,12 @@ void World::loadTileset(const std::string &source, int firstId)
     int columns = tilesetXMLElement->IntAttribute("columns");
     int tileCount = tilesetXMLElement->IntAttribute("tilecount");
     std::filesystem::path tilesetTexturePath = imageXMLElement->Attribute("source");
-    SDL_Texture* texture = Renderer::loadTexture(tilesetTexturePath.replace_extension().string(), "./assets/Worlds/Tilesets/" + tilesetTexturePath.replace_extension().string() + ".png");
 
+    TilesetData tileset;
+    tileset.textureName = tilesetTexturePath.replace_extension().string();
+    tileset.firstId = firstId;
+
+    // Tile positions are relative to the tileset image until its texture is loaded.
     for (int id = 0; id < tileCount; id++)
     {
         Tile tile;
@@ -272,27 +447,30 @@ void World::loadTileset(const std::string &source, int firstId)
         tile.height = height;
         tile.tilesetWidth = imageXMLElement->IntAttribute("width");
         tile.tilesetHeight = imageXMLElement->IntAttribute("height");
-        tile.texture = texture;
+        tile.texture = nullptr;
+        tile.textureX = 0;
+        tile.textureY = 0;
         tile.x = id % tile.columns * tile.width;
         tile.y = id / tile.columns * tile.height;
         tile.currentX = tile.x;
         tile.currentY = tile.y;
 
-        tiles.insert(tiles.begin() + id + firstId, tile);
+        tileset.tiles.push_back(tile);
     }
 
     for (const tinyxml2::XMLElement* tileXMLElement = tilesetXMLElement->FirstChildElement("tile"); tileXMLElement != nullptr; tileXMLElement = tileXMLElement->NextSiblingElement("tile"))
     {
-        int id = tileXMLElement->IntAttribute("id");
+        const int id = tileXMLElement->IntAttribute("id");
+        if (id < 0 || id >= static_cast<int>(tileset.tiles.size())) continue;
 
         if (const char* tileType = tileXMLElement->Attribute("type"))
-            tiles[id + firstId].data.insert({"type", tileType});
+            tileset.tiles[id].data.insert({"type", tileType});
 
         if (const tinyxml2::XMLElement* propertiesXMLElement = tileXMLElement->FirstChildElement("properties"))
         {
             for (const tinyxml2::XMLElement* propertyXMLElement = propertiesXMLElement->FirstChildElement("property"); propertyXMLElement != nullptr; propertyXMLElement = propertyXMLElement->NextSiblingElement("property"))
             {
-                tiles[id + firstId].data.insert({propertyXMLElement->Attribute("name"), propertyXMLElement->Attribute("value")});
+                tileset.tiles[id].data.insert({propertyXMLElement->Attribute("name"), propertyXMLElement->Attribute("value")});
             }
         }
 
@@ -300,38 +478,37 @@ void World::loadTileset(const std::string &source, int firstId)
         {
             for (const tinyxml2::XMLElement* animElement = animationXML->FirstChildElement("frame"); animElement != nullptr; animElement = animElement->NextSiblingElement("frame"))
             {
-                tiles[id + firstId].animated = true;
+                tileset.tiles[id].animated = true;
 
                 AnimationTileFrame frame{};
                 frame.duration = animElement->IntAttribute("duration");
                 frame.tileId = animElement->IntAttribute("tileid");
-                tiles[id + firstId].animationFrames.push_back(frame);
+                tileset.tiles[id].animationFrames.push_back(frame);
             }
         }
     }
-    Log::write("World", LogLevel::info, "Loaded %s tileset", tilesetTexturePath.replace_extension().string().c_str());
+
+    tilemap.tilesets.push_back(std::move(tileset));
 }
 
-void World::loadTilemap(const std::string& tilemapName)
+static TilemapData parseTilemap(const std::string& tilemapName)
 {
-    const std::string tileMapPath = "./assets/Worlds/" + tilemapName + ".tmx";
+    TilemapData tilemap;
 
-    tiles.clear();
-    layers.clear();
-    foregroundLayers.clear();
-    worldObjects.clear();
+    std::string tilemapFile;
+    Assets::readFile("Worlds/" + tilemapName + ".tmx", tilemapFile);
 
     tinyxml2::XMLDocument tilemapXML;
-    tilemapXML.LoadFile(tileMapPath.c_str());
+    tilemapXML.Parse(tilemapFile.data(), tilemapFile.size());
     if (tilemapXML.Error())
     {
-        Log::write("World", LogLevel::error, "Can't load tilemap: %s / %s", tilemapName.c_str(), tilemapXML.ErrorName());
-        return;
+        tilemap.errors.push_back("Can't load tilemap: " + tilemapName + " / " + tilemapXML.ErrorName());
+        return tilemap;
     }
 
     tinyxml2::XMLElement* mapXMLElement = tilemapXML.FirstChildElement("map");
-    worldWidth = mapXMLElement->IntAttribute("width");
-    worldHeight = mapXMLElement->IntAttribute("height");
+    tilemap.width = mapXMLElement->IntAttribute("width");
+    tilemap.height = mapXMLElement->IntAttribute("height");
     float tileWidth = mapXMLElement->IntAttribute("tilewidth");
     float tileHeight = mapXMLElement->IntAttribute("tileheight");
 
@@ -352,29 +529,19 @@ void World::loadTilemap(const std::string& tilemapName)
 
         if (const char* layerClass = element->Attribute("class"); layerClass && !strcmp("foreground", layerClass))
         {
-            foregroundLayers.push_back(layer);
+            tilemap.foregroundLayers.push_back(layer);
         }
         else
         {
-            layers.push_back(layer);
+            tilemap.layers.push_back(layer);
         }
     }
 
-    Tile nullTile;
-    nullTile.animated = false;
-    nullTile.height = 0;
-    nullTile.width = 0;
-    nullTile.x = 0;
-    nullTile.y = 0;
-    nullTile.currentX = 0;
-    nullTile.currentY = 0;
-    tiles.push_back(nullTile);
-
     for (const tinyxml2::XMLElement* element = mapXMLElement->FirstChildElement("tileset"); element != nullptr; element = element->NextSiblingElement("tileset"))
     {
         int firstId = element->IntAttribute("firstgid");
         std::string source = element->Attribute("source");
-        loadTileset(source, firstId);
+        parseTileset(source, firstId, tilemap);
     }
 
     for (tinyxml2::XMLElement* objectGroup = mapXMLElement->FirstChildElement("objectgroup"); objectGroup != nullptr; objectGroup = objectGroup->NextSiblingElement())
@@ -476,20 +643,195 @@ void World::loadTilemap(const std::string& tilemapName)
             {
                 hitbox.vertices.emplace_back(x, y);
                 hitbox.vertices.emplace_back(x, y + height);
-                hitbox.vertices.emplace_back(x + width, y);
                 hitbox.vertices.emplace_back(x + width, y + height);
+                hitbox.vertices.emplace_back(x + width, y);
             }
             worldObject->setHitbox(hitbox);
-            worldObjects.push_back(worldObject);
+            tilemap.worldObjects.push_back(worldObject);
+        }
+    }
+    tilemap.loaded = true;
+    return tilemap;
+}
+
+void World::loadTileset(TilesetData& tileset)
+{
+    const TextureRegion region = Renderer::loadTexture(tileset.textureName, "Worlds/Tilesets/" + tileset.textureName + ".png");
+    if (region.texture != nullptr) tilesetTextures.push_back(tileset.textureName);
+
+    for (size_t id = 0; id < tileset.tiles.size(); id++)
+    {
+        Tile& tile = tileset.tiles[id];
+        tile.texture = region.texture;
+        tile.textureX = region.rect.x;
+        tile.textureY = region.rect.y;
+        tile.x += tile.textureX;
+        tile.y += tile.textureY;
+        tile.currentX = tile.x;
+        tile.currentY = tile.y;
+
+        tiles.insert(tiles.begin() + id + tileset.firstId, std::move(tile));
+    }
+    Log::write("World", LogLevel::info, "Loaded %s tileset", tileset.textureName.c_str());
+}
+
+void World::loadTilemap(const std::string& tilemapName)
+{
+    // Released once the new tilesets hold their references, so a tileset both tilemaps use isn't unloaded in between.
+    const std::vector<std::string> previousTilesetTextures = std::move(tilesetTextures);
+    tilesetTextures.clear();
+    tiles.clear();
+    layers.clear();
+    foregroundLayers.clear();
+    worldObjects.clear();
+
+    TilemapData tilemap;
+    if (preparedTilemap && preparedTilemap->name == tilemapName)
+    {
+        if (!preparedTilemap->parsed)
+        {
+            Jobs::wait(preparedTilemap->parsing);
+            preparedTilemap->parsed = true;
+        }
+        tilemap = std::move(preparedTilemap->tilemap);
+    }
+    else
+    {
+        tilemap = parseTilemap(tilemapName);
+    }
+
+    for (const std::string& error : tilemap.errors)
+    {
+        Log::write("World", LogLevel::error, "%s", error.c_str());
+    }
+
+    if (tilemap.loaded)
+    {
+        worldWidth = tilemap.width;
+        worldHeight = tilemap.height;
+        layers = std::move(tilemap.layers);
+        foregroundLayers = std::move(tilemap.foregroundLayers);
+
+        Tile nullTile;
+        nullTile.animated = false;
+        nullTile.height = 0;
+        nullTile.width = 0;
+        nullTile.x = 0;
+        nullTile.y = 0;
+        nullTile.textureX = 0;
+        nullTile.textureY = 0;
+        nullTile.currentX = 0;
+        nullTile.currentY = 0;
+        tiles.push_back(nullTile);
+
+        for (TilesetData& tileset : tilemap.tilesets)
+        {
+            loadTileset(tileset);
+        }
+
+        worldObjects = std::move(tilemap.worldObjects);
+        Log::write("World", LogLevel::info, "Loaded %s tilemap", tilemapName.c_str());
+    }
+
+    // The tileset textures are referenced by the tiles now.
+    if (preparedTilemap && preparedTilemap->name == tilemapName)
+    {
+        releasePreparedTilemap();
+    }
+
+    for (const std::string& textureName : previousTilesetTextures)
+    {
+        Renderer::releaseTexture(textureName);
+    }
+}
+
+void World::prepareTilemap(const std::string& tilemapName)
+{
+    if (preparedTilemap && preparedTilemap->name == tilemapName) return;
+
+    releasePreparedTilemap();
+    preparedTilemap = std::make_unique<PreparedTilemap>();
+    preparedTilemap->name = tilemapName;
+    PreparedTilemap* tilemap = preparedTilemap.get();
+    preparedTilemap->parsing = Jobs::run([tilemap] { tilemap->tilemap = parseTilemap(tilemap->name); });
+}
+
+void World::prepareSprite(const std::string& spriteName)
+{
+    preparedSpriteSheets.push_back(SpriteSheetCache::load(spriteName));
+}
+
+bool World::isPrepared()
+{
+    if (preparedTilemap)
+    {
+        if (!preparedTilemap->parsed)
+        {
+            if (!Jobs::isFinished(preparedTilemap->parsing)) return false;
+
+            preparedTilemap->parsed = true;
+
+            // Decoded in the background, the tiles get them from the texture cache when the tilemap is loaded.
+            for (const TilesetData& tileset : preparedTilemap->tilemap.tilesets)
+            {
+                Renderer::requestTexture(tileset.textureName, "Worlds/Tilesets/" + tileset.textureName + ".png", [](const TextureRegion&) {});
+                preparedTilemap->textureNames.push_back(tileset.textureName);
+            }
         }
+
+        for (const std::string& textureName : preparedTilemap->textureNames)
+        {
+            if (Renderer::isTextureLoading(textureName)) return false;
+        }
+    }
+
+    for (const std::shared_ptr<const SpriteSheet>& spriteSheet : preparedSpriteSheets)
+    {
+        if (Renderer::isTextureLoading(spriteSheet->name)) return false;
+    }
+    return true;
+}
+
+void World::releasePreparedTilemap()
+{
+    if (!preparedTilemap) return;
+
+    // The job writes into the prepared tilemap, so it has to finish before the tilemap is freed.
+    Jobs::wait(preparedTilemap->parsing);
+
+    // World objects that were handed to the world have been moved out already.
+    for (const WorldObject* worldObject : preparedTilemap->tilemap.worldObjects)
+    {
+        delete worldObject;
     }
-    Log::write("World", LogLevel::info, "Loaded %s tilemap", tilemapName.c_str());
+
+    for (const std::string& textureName : preparedTilemap->textureNames)
+    {
+        Renderer::releaseTexture(textureName);
+    }
+    preparedTilemap.reset();
 }
 
 World::~World()
 {
+    releasePreparedTilemap();
+
     for (const WorldObject* worldObject : worldObjects)
     {
         delete worldObject;
     }
+
+    for (const std::string& textureName : tilesetTextures)
+    {
+        Renderer::releaseTexture(textureName);
+    }
+
+    // Entities outlive the world, they must not report their moves to its grid anymore.
+    for (Entity* entity : entities)
+    {
+        entity->setSpatialGrid(nullptr, 0);
+    }
+
+    delete hudGrid;
+    delete spatialGrid;
 }
\ No newline at end of file
@@ -4,14 +4,23 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "Entity.hpp"
 #include "Collision/Intersection.hpp"
 #include "Graphics/HUDObject.hpp"
+#include "World/HUDGrid.hpp"
+#include "World/SpatialGrid.hpp"
 #include "World/Tiles.hpp"
 #include "World/WorldObject.hpp"
 
+struct PreparedTilemap;
+struct SpriteSheet;
+struct TilesetData;
+
 class World
 {
 public:
@@ -19,6 +28,9 @@ public:
 
     void initInternal();
     void updateInternal();
+    void updateEntities();
+    void updateAnimations();
+    bool isPrepared();
 
     //Internal functions end here
 
@@ -92,6 +104,13 @@ public:
      */
     void deleteAllHUDObjects();
 
+    /**
+     * @brief Get the topmost HUD object under the cursor. This is resolved once per cursor movement or HUD layout change.
+     * 
+     * @return the HUD object under the cursor or NULL if there is none.
+     */
+    HUDObject* getHUDObjectUnderCursor() const;
+
     /**
      * @brief Get all the world objects in the world.
      *
@@ -106,6 +125,20 @@ public:
      */
     void loadTilemap(const std::string& tilemapName);
 
+    /**
+     * @brief Parse a tilemap on a background thread and decode its tilesets, so loadTilemap doesn't have to wait for it. Call it from onPrepare.
+     * 
+     * @param tilemapName the name of the tilemap
+     */
+    void prepareTilemap(const std::string& tilemapName);
+
+    /**
+     * @brief Load the frames of a sprite and decode its image in the background before the world is loaded. Call it from onPrepare.
+     * 
+     * @param spriteName the name of the sprite
+     */
+    void prepareSprite(const std::string& spriteName);
+
     /**
      * @brief Get the data of a tile. Use `"type"` to get the class of the tile.
      * 
@@ -123,6 +156,64 @@ public:
      */
     std::vector<Intersection> getIntersections(const Entity* entity) const;
 
+    /**
+     * @brief Get all entities whose position is within a radius around a point.
+     * 
+     * @param center the center of the circle in world coordinates
+     * @param radius the radius of the circle in world units
+     * @param result the vector the entities are appended to
+     */
+    void getEntitiesInRadius(const Vector2f& center, float radius, std::vector<Entity*>& result) const;
+
+    /**
+     * @brief Get all entities whose hitbox overlaps a rectangle.
+     * 
+     * @param position the top left corner of the rectangle in world coordinates
+     * @param size the size of the rectangle in world units
+     * @param result the vector the entities are appended to
+     */
+    void getEntitiesInRectangle(const Vector2f& position, const Vector2f& size, std::vector<Entity*>& result) const;
+
+    /**
+     * @brief Get the entities closest to a point, sorted by distance.
+     * 
+     * @param position the point in world coordinates
+     * @param count the maximum number of entities to return
+     * @param result the vector the entities are appended to
+     * @param filter an optional function that returns false for entities that should be skipped
+     */
+    void getNearestEntities(const Vector2f& position, size_t count, std::vector<Entity*>& result, const std::function<bool(const Entity*)>& filter = nullptr) const;
+
+    /**
+     * @brief Get all entities whose hitbox contains a point.
+     * 
+     * @param position the point in world coordinates
+     * @return the entities at the point ordered from bottom to top. The vector is only valid until the next query.
+     */
+    const std::vector<Entity*>& getEntitiesAtPosition(const Vector2f& position) const;
+
+    /**
+     * @brief Get all entities whose hitbox contains a point. Unlike the overload returning a vector, this one is safe to call from thread safe entities.
+     * 
+     * @param position the point in world coordinates
+     * @param result the vector the entities are appended to, ordered from bottom to top
+     */
+    void getEntitiesAtPosition(const Vector2f& position, std::vector<Entity*>& result) const;
+
+    /**
+     * @brief Get the topmost entity under the cursor.
+     * 
+     * @return the entity under the cursor or NULL if there is none.
+     */
+    Entity* getEntityUnderCursor() const;
+
+    /**
+     * @brief Set the cell size of the grid used for spatial queries. It should be about the size of the largest entities.
+     * 
+     * @param cellSize the size of a cell in world units
+     */
+    void setSpatialCellSize(float cellSize);
+
     /**
      * @brief The update function can be implemented in inhereting classes. This function is called once every frame.
      * 
@@ -141,6 +232,12 @@ public:
      */
     virtual void onUnload() = 0;
 
+    /**
+     * @brief The onPrepare function can be implemented in inhereting classes. This function is called when the world is staged with Bee::prepareWorld, while the current world keeps running. Start loading what onLoad needs with prepareTilemap and prepareSprite.
+     * 
+     */
+    virtual void onPrepare() {}
+
     /**
      * @brief The destructor can be implemented in inhereting classes.
      * 
@@ -150,11 +247,18 @@ public:
 private:
     int worldHeight = 0;
     int worldWidth = 0;
+    HUDGrid* hudGrid = nullptr;
+    SpatialGrid* spatialGrid = nullptr;
     std::vector<Entity*> entities;
+    std::vector<Entity*> parallelEntities;
     std::vector<WorldObject*> worldObjects;
     std::vector<HUDObject*> hudObjects;
     std::vector<TileLayer> foregroundLayers;
     std::vector<TileLayer> layers;
     std::vector<Tile> tiles;
-    void loadTileset(const std::string& source, int firstId);
+    std::vector<std::string> tilesetTextures;
+    std::unique_ptr<PreparedTilemap> preparedTilemap;
+    std::vector<std::shared_ptr<const SpriteSheet>> preparedSpriteSheets;
+    void loadTileset(TilesetData& tileset);
+    void releasePreparedTilemap();
 };
\ No newline at end of file
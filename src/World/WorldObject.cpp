@@ -1,5 +1,8 @@
 #include "WorldObject.hpp"
 
+#include "Collision/Collision.hpp"
+#include "Collision/Intersection.hpp"
+
 Hitbox WorldObject::getHitbox() const
 {
     return hitbox;
@@ -8,4 +11,56 @@ Hitbox WorldObject::getHitbox() const
 void WorldObject::setHitbox(const Hitbox& hitbox)
 {
     this->hitbox = hitbox;
-}
\ No newline at end of file
+    hitboxParts.clear();
+
+    if (hitbox.isEllipse || hitbox.vertices.size() <= 3)
+    {
+        hitboxParts.push_back({hitbox, {}, {}});
+    }
+    else
+    {
+        for (const std::vector<Vector2f>& polygon : Collision::decomposeConvex(hitbox.vertices))
+        {
+            HitboxPart part;
+            part.hitbox.vertices = polygon;
+            for (const Vector2f& vertex : polygon)
+            {
+                part.hitbox.center += vertex;
+            }
+            part.hitbox.center = part.hitbox.center / polygon.size();
+            hitboxParts.push_back(part);
+        }
+    }
+
+    for (HitboxPart& part : hitboxParts)
+    {
+        Collision::getBounds(part.hitbox, part.min, part.max);
+    }
+    Collision::getBounds(hitbox, min, max);
+}
+
+bool WorldObject::checkCollision(const Hitbox& other, const Vector2f& otherMin, const Vector2f& otherMax, Intersection& intersection) const
+{
+    if (otherMax.x < min.x || otherMin.x > max.x || otherMax.y < min.y || otherMin.y > max.y)
+        return false;
+
+    bool colliding = false;
+
+    for (const HitboxPart& part : hitboxParts)
+    {
+        if (otherMax.x < part.min.x || otherMin.x > part.max.x || otherMax.y < part.min.y || otherMin.y > part.max.y)
+            continue;
+
+        Intersection partIntersection = intersection;
+        if (Collision::checkCollision(other, part.hitbox, partIntersection))
+        {
+            if (!colliding || partIntersection.penetrationDepth > intersection.penetrationDepth)
+            {
+                intersection = partIntersection;
+            }
+            colliding = true;
+        }
+    }
+
+    return colliding;
+}
@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Properties.hpp"
 #include "Collision/Hitbox.hpp"
 
+struct Intersection;
+
 class WorldObject
 {
 public:
@@ -14,6 +18,7 @@ public:
 
     Hitbox getHitbox() const;
     void setHitbox(const Hitbox& hitbox);
+    bool checkCollision(const Hitbox& other, const Vector2f& otherMin, const Vector2f& otherMax, Intersection& intersection) const;
 
     //Internal functions end here
 
@@ -24,5 +29,15 @@ public:
     Properties properties;
 
 private:
+    struct HitboxPart
+    {
+        Hitbox hitbox;
+        Vector2f min;
+        Vector2f max;
+    };
+
     Hitbox hitbox;
+    Vector2f min;
+    Vector2f max;
+    std::vector<HitboxPart> hitboxParts;
 };
\ No newline at end of file
@@ -0,0 +1,116 @@
+// Packs an assets directory into a single file that the engine can memory map.
+// Usage: bee-pack <assets directory> <output file> [--compress]
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Assets/Compression.hpp"
+#include "Assets/PackFormat.hpp"
+
+struct PackFile
+{
+    std::string name;
+    std::vector<uint8_t> data;
+    bool compressed = false;
+    uint64_t size = 0;
+};
+
+int main(const int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: bee-pack <assets directory> <output file> [--compress]" << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path directory = argv[1];
+    const bool compress = argc > 3 && strcmp(argv[3], "--compress") == 0;
+    std::vector<PackFile> files;
+
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(directory))
+    {
+        if (!entry.is_regular_file()) continue;
+
+        std::ifstream input(entry.path(), std::ios::binary);
+        PackFile file;
+        file.name = entry.path().lexically_relative(directory).generic_string();
+        file.data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        file.size = file.data.size();
+
+        // Only keep the compressed data if it saves at least an eighth, PNG and OGG files barely shrink.
+        if (compress)
+        {
+            std::vector<uint8_t> compressedData = Compression::compress(file.data.data(), file.data.size());
+            if (compressedData.size() < file.data.size() - file.data.size() / 8)
+            {
+                file.data = std::move(compressedData);
+                file.compressed = true;
+            }
+        }
+
+        files.push_back(std::move(file));
+    }
+
+    std::sort(files.begin(), files.end(), [](const PackFile& left, const PackFile& right) {
+        return left.name < right.name;
+    });
+
+    PackHeader header = {};
+    memcpy(header.magic, packMagic, sizeof(packMagic));
+    header.version = packVersion;
+    header.entryCount = static_cast<uint32_t>(files.size());
+
+    std::vector<PackEntry> entries(files.size());
+    uint64_t offset = sizeof(PackHeader) + sizeof(PackEntry) * files.size();
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        entries[i].nameOffset = static_cast<uint32_t>(offset);
+        entries[i].nameLength = static_cast<uint32_t>(files[i].name.size());
+        offset += files[i].name.size();
+    }
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        // Data is 8 byte aligned, so the engine can read mapped files in place.
+        offset = (offset + 7) & ~static_cast<uint64_t>(7);
+        entries[i].dataOffset = offset;
+        entries[i].storedSize = files[i].data.size();
+        entries[i].size = files[i].size;
+        entries[i].flags = files[i].compressed ? packEntryCompressed : 0;
+        offset += files[i].data.size();
+    }
+
+    std::ofstream output(argv[2], std::ios::binary);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(sizeof(PackEntry) * entries.size()));
+
+    for (const PackFile& file : files)
+    {
+        output.write(file.name.data(), static_cast<std::streamsize>(file.name.size()));
+    }
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        while (static_cast<uint64_t>(output.tellp()) < entries[i].dataOffset)
+        {
+            output.put(0);
+        }
+        output.write(reinterpret_cast<const char*>(files[i].data.data()), static_cast<std::streamsize>(files[i].data.size()));
+    }
+
+    if (!output)
+    {
+        std::cerr << "Can't write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << files.size() << " files into " << argv[2] << std::endl;
+    return 0;
+}